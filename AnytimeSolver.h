@@ -0,0 +1,305 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+#include "BoardHasher.h"
+#include "Frontier.h"
+#include "Heuristics.h"
+#include "MoveDiscovery.h"
+#include "solver.h"
+#include "VisitedSet.h"
+
+struct AnytimeOptions
+{
+    // Limits for the whole solve, zero means unlimited
+    SearchBudget m_budget;
+
+    // Number of boards kept per level by the initial beam search
+    std::size_t m_beamWidth = 64;
+
+    // Weights for the successive weighted A* searches, each one should be lower than the previous one
+    // Only a final weight of 1 can prove a solution to be optimal
+    std::vector<double> m_weights = { 5.0, 2.0, 1.5, 1.0 };
+};
+
+template <int BlockCount>
+struct AnytimeResult
+{
+    // Number of moves of the best solution found so far, -1 if none was found
+    int m_length;
+
+    // Whether no shorter solution exists (or no solution at all if m_length is -1)
+    bool m_optimal;
+
+    // All states from the initial state up to & including the solution
+    std::vector<BoardState<BlockCount>> m_path;
+};
+
+// Finds a solution quickly and improves it while the budget allows
+// A beam search provides the first solution, followed by weighted A* searches with decreasing weights.
+// Every search prunes boards which can't beat the best solution found so far.
+template <
+    int BlockCount,
+    typename MoveDiscovery,
+    typename Heuristic
+>
+class AnytimeSolver
+{
+public:
+    using Index = typename Frontier<BlockCount>::Index;
+
+public:
+    AnytimeSolver(const Puzzle<BlockCount> &puzzle, Heuristic heuristic = Heuristic{})
+        : m_puzzle{ puzzle }
+        , m_hasher{ puzzle }
+        , m_heuristic{ heuristic }
+        , m_startTime{}
+        , m_expandedStates{ 0 }
+        , m_budget{}
+        , m_budgetChecks{ 0 }
+        , m_outOfBudget{ false }
+    {
+    }
+
+    AnytimeResult<BlockCount> solve(const AnytimeOptions &options)
+    {
+        m_startTime = std::chrono::steady_clock::now();
+        m_expandedStates = 0;
+        m_budget = options.m_budget;
+        m_budgetChecks = 0;
+        m_outOfBudget = false;
+
+        if (isSolution(m_puzzle.m_initialState, m_puzzle.m_goal))
+        {
+            return AnytimeResult<BlockCount>{ 0, true, { m_puzzle.m_initialState } };
+        }
+
+        AnytimeResult<BlockCount> best{ -1, false, {} };
+        beamSearch(options.m_beamWidth, best);
+
+        for (const auto weight : options.m_weights)
+        {
+            const auto completed = weightedAStar(weight, best);
+            if (!completed)
+            {
+                break;
+            }
+            if (weight <= 1.0)
+            {
+                // Admissible heuristic & only pruning boards which can't beat the best solution
+                best.m_optimal = true;
+                break;
+            }
+        }
+
+        return best;
+    }
+
+    // Number of states expanded during the last solve
+    std::size_t expandedStates() const
+    {
+        return m_expandedStates;
+    }
+
+private:
+    // Once out of budget, stays out of budget for the rest of the solve
+    bool outOfBudget()
+    {
+        // Checking the clock for every expanded state is too expensive
+        constexpr auto checksPerClockRead = 256u;
+
+        m_outOfBudget = m_outOfBudget
+            || (m_budget.m_expandedStates > 0 && m_expandedStates >= m_budget.m_expandedStates)
+            || (m_budget.m_time.count() > 0
+                && m_budgetChecks++ % checksPerClockRead == 0
+                && std::chrono::steady_clock::now() - m_startTime >= m_budget.m_time);
+        return m_outOfBudget;
+    }
+
+    int estimate(const BoardState<BlockCount> &state) const
+    {
+        return m_heuristic(state, m_puzzle.m_goal);
+    }
+
+    // Keeps only the beamWidth most promising boards of every level
+    void beamSearch(std::size_t beamWidth, AnytimeResult<BlockCount> &best)
+    {
+        Frontier<BlockCount> archive{ m_puzzle.m_initialState };
+        VisitedSet<int, int> visited{};
+        archive.push_back(m_puzzle.m_initialState);
+        visited.insert(m_hasher.hash(m_puzzle.m_initialState), 0);
+
+        std::vector<Index> beam{ 0 };
+        std::vector<std::pair<int, Index>> candidates;
+        for (auto depth = 0; !beam.empty(); ++depth)
+        {
+            candidates.clear();
+            for (const auto index : beam)
+            {
+                if (outOfBudget())
+                {
+                    return;
+                }
+
+                ++m_expandedStates;
+                const auto state = std::make_shared<BoardState<BlockCount>>(archive.at(index, depth));
+                for (auto &move : MoveDiscovery::gatherMoves(m_puzzle.m_dimensions, state, m_puzzle.m_forbiddenSpots))
+                {
+                    const auto child = move();
+                    if (!visited.insert(m_hasher.hash(child), depth + 1))
+                    {
+                        continue;
+                    }
+
+                    archive.push_back(child, index);
+                    if (isSolution(child, m_puzzle.m_goal))
+                    {
+                        improve(best, depth + 1, archive, static_cast<Index>(archive.size() - 1));
+                        return;
+                    }
+                    candidates.emplace_back(estimate(child), static_cast<Index>(archive.size() - 1));
+                }
+            }
+
+            const auto kept = std::min(beamWidth, candidates.size());
+            std::partial_sort(begin(candidates), begin(candidates) + kept, end(candidates));
+            beam.clear();
+            for (auto i = 0u; i < kept; ++i)
+            {
+                beam.push_back(candidates[i].second);
+            }
+        }
+    }
+
+    // Returns false if the budget ran out before the search completed
+    bool weightedAStar(double weight, AnytimeResult<BlockCount> &best)
+    {
+        struct Entry
+        {
+            double m_priority;
+            int m_distance;
+            Index m_node;
+
+            // Lowest priority first, deepest first on ties
+            bool operator<(const Entry &other) const
+            {
+                return m_priority > other.m_priority
+                    || (m_priority == other.m_priority && m_distance < other.m_distance);
+            }
+        };
+
+        Frontier<BlockCount> archive{ m_puzzle.m_initialState };
+        std::unordered_map<int, int> bestDistances;
+        std::priority_queue<Entry> open;
+
+        const auto canImprove = [&](int distance, int estimate)
+        {
+            return best.m_length < 0 || distance + estimate < best.m_length;
+        };
+        const auto push = [&](const BoardState<BlockCount> &state, int distance, Index parent)
+        {
+            const auto estimated = estimate(state);
+            if (!canImprove(distance, estimated))
+            {
+                return;
+            }
+
+            // Weighted A* is inconsistent, so boards are reopened when reached by a shorter path
+            const auto known = bestDistances.emplace(m_hasher.hash(state), distance);
+            if (!known.second)
+            {
+                if (known.first->second <= distance)
+                {
+                    return;
+                }
+                known.first->second = distance;
+            }
+
+            archive.push_back(state, parent);
+            open.push(Entry{ distance + weight * estimated, distance, static_cast<Index>(archive.size() - 1) });
+        };
+
+        push(m_puzzle.m_initialState, 0, 0);
+        while (!open.empty())
+        {
+            if (outOfBudget())
+            {
+                return false;
+            }
+
+            const auto entry = open.top();
+            open.pop();
+
+            const auto state = std::make_shared<BoardState<BlockCount>>(archive.at(entry.m_node, entry.m_distance));
+            if (bestDistances[m_hasher.hash(*state)] < entry.m_distance || !canImprove(entry.m_distance, estimate(*state)))
+            {
+                // Stale entry, or the best solution improved since it was queued
+                continue;
+            }
+
+            if (isSolution(*state, m_puzzle.m_goal))
+            {
+                improve(best, entry.m_distance, archive, entry.m_node);
+                return true;
+            }
+
+            ++m_expandedStates;
+            for (auto &move : MoveDiscovery::gatherMoves(m_puzzle.m_dimensions, state, m_puzzle.m_forbiddenSpots))
+            {
+                push(move(), entry.m_distance + 1, entry.m_node);
+            }
+        }
+
+        return true;
+    }
+
+    // Replaces best by the solution ending at node, if it is shorter
+    // Note: the parent of a state in the archive is always exactly one move closer to the initial state
+    static void improve(AnytimeResult<BlockCount> &best, int length, const Frontier<BlockCount> &archive, Index node)
+    {
+        if (best.m_length >= 0 && best.m_length <= length)
+        {
+            return;
+        }
+
+        std::vector<BoardState<BlockCount>> reversedPath;
+        for (auto distance = length; distance >= 0; --distance)
+        {
+            reversedPath.push_back(archive.at(node, distance));
+            node = archive.parent(node);
+        }
+
+        best.m_length = length;
+        best.m_path = std::vector<BoardState<BlockCount>>(reversedPath.rbegin(), reversedPath.rend());
+    }
+
+private:
+    const Puzzle<BlockCount> m_puzzle;
+    BoardHasher<> m_hasher;
+    Heuristic m_heuristic;
+
+    std::chrono::steady_clock::time_point m_startTime;
+    std::size_t m_expandedStates;
+    SearchBudget m_budget;
+
+    // Calls of outOfBudget(), stale entries of weighted A* included, to read the clock every so often
+    std::size_t m_budgetChecks;
+    bool m_outOfBudget;
+};
+
+template <int BlockCount, typename MoveDiscovery = MoveRunnerFirst<>, typename Heuristic = RunnerManhattanDistance>
+AnytimeSolver<BlockCount, MoveDiscovery, Heuristic> makeAnytimeSolver(const Puzzle<BlockCount> &puzzle)
+{
+    return AnytimeSolver<BlockCount, MoveDiscovery, Heuristic>{ puzzle };
+}
+
+template <int BlockCount, typename Heuristic, typename MoveDiscovery = MoveRunnerFirst<>>
+AnytimeSolver<BlockCount, MoveDiscovery, Heuristic> makeAnytimeSolver(const Puzzle<BlockCount> &puzzle, Heuristic heuristic)
+{
+    return AnytimeSolver<BlockCount, MoveDiscovery, Heuristic>{ puzzle, std::move(heuristic) };
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+
+#include "MoveDiscovery.h"
+#include "solver.h"
+
+// Shared flag to stop a running search from another thread
+// Copies refer to the same flag, so the caller keeps one & hands another to the search
+class CancellationToken
+{
+public:
+    CancellationToken()
+        : m_cancelled{ std::make_shared<std::atomic<bool>>(false) }
+    {
+    }
+
+    void cancel()
+    {
+        m_cancelled->store(true);
+    }
+
+    bool cancelled() const
+    {
+        return m_cancelled->load();
+    }
+
+private:
+    std::shared_ptr<std::atomic<bool>> m_cancelled;
+};
+
+struct AsyncOptions
+{
+    // The search stops with OutOfBudget once the deadline has passed
+    std::chrono::steady_clock::time_point m_deadline = std::chrono::steady_clock::time_point::max();
+
+    // The search stops with Cancelled once the token is cancelled
+    CancellationToken m_cancellation{};
+
+    // Called on the searching thread after every batch
+    std::function<void(const SearchProgress &)> m_progress{};
+
+    // States expanded between checks of the cancellation token, the deadline & progress reports
+    std::size_t m_batchSize = 4096;
+};
+
+// Runs the level search of puzzle on its own thread
+// The search runs as consecutive solveWithBudget() calls of a single batch each, checking for
+// cancellation & the deadline in between. The solver lives in the task, so all its memory is released
+// as soon as the search stops, whether it finished or not.
+// Note: like any std::async future, destroying it waits for the search to stop, cancel first to abandon it
+template <int BlockCount, typename MoveDiscovery = MoveRunnerFirst<>>
+std::future<SearchResult> solveAsync(const Puzzle<BlockCount> &puzzle, AsyncOptions options = {})
+{
+    return std::async(std::launch::async, [puzzle, options]()
+    {
+        Solver<BlockCount, MoveDiscovery> solver{ puzzle };
+        const auto stopped = [&](SearchStatus status)
+        {
+            const auto progress = solver.progress();
+            return SearchResult{ status, progress.m_depth, progress.m_expandedStates };
+        };
+
+        while (true)
+        {
+            if (options.m_cancellation.cancelled())
+            {
+                return stopped(SearchStatus::Cancelled);
+            }
+
+            const auto timeLeft = options.m_deadline - std::chrono::steady_clock::now();
+            if (timeLeft <= std::chrono::steady_clock::duration::zero())
+            {
+                return stopped(SearchStatus::OutOfBudget);
+            }
+
+            // Deadline also bounds the batch itself, as a single batch of a wide level can take a while
+            const auto batchTime = options.m_deadline == std::chrono::steady_clock::time_point::max()
+                ? std::chrono::milliseconds{ 0 }
+                : std::max(std::chrono::milliseconds{ 1 }, std::chrono::duration_cast<std::chrono::milliseconds>(timeLeft));
+            const auto result = solver.solveWithBudget(SearchBudget{ batchTime, options.m_batchSize });
+            if (result.m_status != SearchStatus::OutOfBudget)
+            {
+                return SearchResult{ result.m_status, result.m_distance, solver.progress().m_expandedStates };
+            }
+
+            if (options.m_progress)
+            {
+                options.m_progress(solver.progress());
+            }
+        }
+    });
+}
@@ -1,10 +1,14 @@
 #pragma once
 
+#include <istream>
 #include <numeric>
+#include <ostream>
 #include <random>
 #include <vector>
 
+#include "Frontier.h"
 #include "puzzle.h"
+#include "Serialization.h"
 
 // Need a hash that's both order invariant & block-id invariant
 // i.e. 2 blocks with different ids at the same position should still hash the same
@@ -28,7 +32,7 @@ struct BoardHasher
 {
     // TODO: provide implementation for other HashTypes
     template <int BlockCount>
-    HashType hash(const BoardState<BlockCount> &state)
+    HashType hash(const BoardState<BlockCount> &state) const
     {
         HashType result{};
         result ^= runnerCode(state.m_runner);
@@ -39,6 +43,28 @@ struct BoardHasher
         return result;
     };
 
+    // Hashes every state of a BFS level at once
+    // Works one piece column at a time, so the inner loop is a plain table gather the compiler can vectorize
+    template <int BlockCount>
+    void hash(const Frontier<BlockCount> &frontier, std::vector<HashType> &hashes) const
+    {
+        const auto count = frontier.size();
+        hashes.assign(count, HashType{});
+        auto result = hashes.data();
+
+        for (auto piece = 0; piece < Frontier<BlockCount>::pieceCount; ++piece)
+        {
+            // First blockType is the runner
+            const auto codes = m_codes.data() + (piece == 0 ? 0 : blockTypeOffset(frontier.piece(piece)));
+            const auto xs = frontier.xs(piece).data();
+            const auto ys = frontier.ys(piece).data();
+            for (auto i = 0u; i < count; ++i)
+            {
+                result[i] ^= codes[(xs[i] * m_height) + ys[i]];
+            }
+        }
+    }
+
     template <int BlockCount>
     BoardHasher(const Puzzle<BlockCount> &puzzle)
         : m_width{ puzzle.m_dimensions.m_x }
@@ -68,8 +94,34 @@ struct BoardHasher
         }
     }
 
+    // Codes are randomly generated per instance,
+    // so hashes can only be compared with those of a restored hasher after writing & reading it
+    void write(std::ostream &out) const
+    {
+        serialization::writeVector(out, m_codes);
+    }
+
+    void read(std::istream &in)
+    {
+        std::vector<HashType> codes;
+        serialization::readVector(in, codes);
+        if (codes.size() != m_codes.size())
+        {
+            throw std::runtime_error("Hash codes do not match the puzzle");
+        }
+        m_codes = std::move(codes);
+    }
+
 private:
-    int blockStateCode(const Block &block)
+    HashType blockStateCode(const Block &block) const
+    {
+        return m_codes[
+            blockTypeOffset(block)
+                + (block.m_startX * m_height)
+                + block.m_startY];
+    }
+
+    std::size_t blockTypeOffset(const Block &block) const
     {
         const auto blockType = std::distance(begin(m_blockTypes), std::find_if(
             begin(m_blockTypes),
@@ -80,13 +132,10 @@ private:
         }));
 
         // FIrst blockType is runner, so index offset of the other blocks is 1
-        return m_codes[
-            ((blockType + 1) * (m_width * m_height))
-                + (block.m_startX * m_height)
-                + block.m_startY];
+        return (blockType + 1) * (m_width * m_height);
     }
 
-    int runnerCode(const Block &runner)
+    HashType runnerCode(const Block &runner) const
     {
         // First blockType is the runner
         return m_codes[(runner.m_startX * m_height) + runner.m_startY];
@@ -0,0 +1,238 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "MemoryBackend.h"
+#include "Prefetch.h"
+#include "Serialization.h"
+
+// Visited set for memory-capped searches: a cuckoo filter of small fingerprints of the board hashes
+// Each hash is stored as a FingerprintType in one of 2 buckets of 4 slots, the table is allocated once
+// at the memory limit & never grows, holding up to ~95% of its slots before inserts fail.
+// Boards with the same fingerprint in the same buckets can't be told apart, so a board which was never
+// visited is occasionally reported as visited & pruned from the search: distances found are then upper bounds.
+// expectedFalsePositives() estimates how many boards were pruned that way so far.
+// Distances are not stored, the interface matches the parts of VisitedSet the level search uses.
+template <typename HashType = int, typename DistanceType = int, typename FingerprintType = std::uint16_t>
+class CompactVisitedSet
+{
+    static_assert(std::is_unsigned<FingerprintType>::value, "Fingerprints must be unsigned");
+
+public:
+    // The table comes from memory, or from operator new without a backend
+    explicit CompactVisitedSet(std::size_t memoryLimit = std::size_t{ 1 } << 30, std::shared_ptr<MemoryBackend> memory = nullptr)
+        : m_buckets{ BackendAllocator<Bucket>{ std::move(memory) } }
+        , m_size{ 0 }
+        , m_expectedFalsePositives{ 0.0 }
+    {
+        auto bucketCount = std::size_t{ 1 };
+        while (bucketCount * 2 * sizeof(Bucket) <= memoryLimit)
+        {
+            bucketCount *= 2;
+        }
+        m_buckets.resize(bucketCount, Bucket{});
+    }
+
+    // Returns true if hash was not known yet
+    // Throws once the table is too full to make room for hash, the set is left as it was before the insert
+    bool insert(HashType hash, DistanceType)
+    {
+        const auto key = keyOf(hash);
+        const auto occupied = occupiedSlots(key);
+        if (contains(key))
+        {
+            return false;
+        }
+
+        place(key);
+        ++m_size;
+
+        // Had any of the occupied slots held the same fingerprint, hash would have been pruned
+        m_expectedFalsePositives += static_cast<double>(occupied) / fingerprintValues;
+        return true;
+    }
+
+    // Batched insert-if-absent, isNew[i] is set to 1 if hashes[i] was not known yet
+    // Both buckets of each hash are prefetched one batch ahead, as in VisitedSet
+    template <std::size_t BatchSize = 16>
+    void insert(const HashType *hashes, std::size_t count, DistanceType distance, char *isNew)
+    {
+        const auto prefetchBatch = [&](std::size_t start)
+        {
+            for (auto i = start; i < std::min(count, start + BatchSize); ++i)
+            {
+                prefetch(hashes[i]);
+            }
+        };
+
+        prefetchBatch(0);
+        for (std::size_t start = 0; start < count; start += BatchSize)
+        {
+            prefetchBatch(start + BatchSize);
+            for (auto i = start; i < std::min(count, start + BatchSize); ++i)
+            {
+                isNew[i] = insert(hashes[i], distance) ? 1 : 0;
+            }
+        }
+    }
+
+    // The table never grows
+    void reserve(std::size_t)
+    {
+    }
+
+    bool contains(HashType hash) const
+    {
+        return contains(keyOf(hash));
+    }
+
+    void prefetch(HashType hash) const
+    {
+        const auto key = keyOf(hash);
+        ::prefetch(&m_buckets[key.m_first]);
+        ::prefetch(&m_buckets[alternate(key.m_first, key.m_fingerprint)]);
+    }
+
+    // The table is written as is, reading it requires a set with the same memory limit
+    void write(std::ostream &out) const
+    {
+        serialization::write(out, static_cast<std::uint64_t>(m_buckets.size()));
+        serialization::write(out, static_cast<std::uint64_t>(m_size));
+        serialization::write(out, m_expectedFalsePositives);
+        serialization::writeVector(out, m_buckets);
+    }
+
+    void read(std::istream &in)
+    {
+        serialization::expect(in, static_cast<std::uint64_t>(m_buckets.size()), "visited set memory limit");
+        m_size = static_cast<std::size_t>(serialization::read<std::uint64_t>(in));
+        serialization::read(in, m_expectedFalsePositives);
+        serialization::readVector(in, m_buckets);
+    }
+
+    std::size_t size() const { return m_size; }
+    std::size_t capacity() const { return m_buckets.size() * slotsPerBucket; }
+    std::size_t memoryUsage() const { return m_buckets.size() * sizeof(Bucket); }
+
+    // Chance that a board which was never visited is reported as visited, at the current load
+    double falsePositiveRate() const
+    {
+        return 2.0 * slotsPerBucket * static_cast<double>(m_size) / capacity() / fingerprintValues;
+    }
+
+    // Estimated number of boards pruned by mistake over all inserts so far
+    double expectedFalsePositives() const
+    {
+        return m_expectedFalsePositives;
+    }
+
+private:
+    constexpr static std::size_t slotsPerBucket = 4;
+    constexpr static int maxKicks = 500;
+    constexpr static double fingerprintValues = static_cast<double>(std::numeric_limits<FingerprintType>::max());
+
+    using Bucket = std::array<FingerprintType, slotsPerBucket>;
+
+    struct Key
+    {
+        std::size_t m_first;
+
+        // Never 0, which marks an empty slot
+        FingerprintType m_fingerprint;
+    };
+
+    // Board hashes only have as many bits as HashType, so they are spread out before
+    // taking the bucket from the low bits & the fingerprint from the high bits
+    Key keyOf(HashType hash) const
+    {
+        using Unsigned = typename std::make_unsigned<HashType>::type;
+        auto mixed = static_cast<std::uint64_t>(static_cast<Unsigned>(hash));
+        mixed = (mixed ^ (mixed >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        mixed = (mixed ^ (mixed >> 27)) * 0x94d049bb133111ebULL;
+        mixed ^= mixed >> 31;
+
+        const auto fingerprint = static_cast<FingerprintType>(mixed >> (64 - 8 * sizeof(FingerprintType)));
+        return Key{ static_cast<std::size_t>(mixed) & (m_buckets.size() - 1), fingerprint == 0 ? FingerprintType{ 1 } : fingerprint };
+    }
+
+    // Other bucket of a fingerprint, only needs the current bucket so fingerprints can be moved without their hash
+    std::size_t alternate(std::size_t bucket, FingerprintType fingerprint) const
+    {
+        return (bucket ^ (static_cast<std::size_t>(fingerprint) * 0x5bd1e995u)) & (m_buckets.size() - 1);
+    }
+
+    bool contains(const Key &key) const
+    {
+        const auto holds = [&](const Bucket &bucket)
+        {
+            return std::find(begin(bucket), end(bucket), key.m_fingerprint) != end(bucket);
+        };
+        return holds(m_buckets[key.m_first]) || holds(m_buckets[alternate(key.m_first, key.m_fingerprint)]);
+    }
+
+    std::size_t occupiedSlots(const Key &key) const
+    {
+        const auto occupied = [&](const Bucket &bucket)
+        {
+            return static_cast<std::size_t>(std::count_if(begin(bucket), end(bucket), [](FingerprintType slot) { return slot != 0; }));
+        };
+        return occupied(m_buckets[key.m_first]) + occupied(m_buckets[alternate(key.m_first, key.m_fingerprint)]);
+    }
+
+    bool placeInBucket(std::size_t bucket, FingerprintType fingerprint)
+    {
+        for (auto &slot : m_buckets[bucket])
+        {
+            if (slot == 0)
+            {
+                slot = fingerprint;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Evicts fingerprints to their other bucket until one finds an empty slot
+    // When none does, the evictions are undone, so no fingerprint already in the table is lost
+    void place(const Key &key)
+    {
+        auto bucket = key.m_first;
+        auto fingerprint = key.m_fingerprint;
+        if (placeInBucket(bucket, fingerprint) || placeInBucket(alternate(bucket, fingerprint), fingerprint))
+        {
+            return;
+        }
+
+        for (auto kick = 0; kick < maxKicks; ++kick)
+        {
+            std::swap(fingerprint, m_buckets[bucket][kick % slotsPerBucket]);
+            bucket = alternate(bucket, fingerprint);
+            if (placeInBucket(bucket, fingerprint))
+            {
+                return;
+            }
+        }
+
+        // Every evicted fingerprint knows the bucket it was evicted from, as its other bucket
+        for (auto kick = maxKicks - 1; kick >= 0; --kick)
+        {
+            bucket = alternate(bucket, fingerprint);
+            std::swap(fingerprint, m_buckets[bucket][kick % slotsPerBucket]);
+        }
+        throw std::runtime_error("Visited set memory limit reached");
+    }
+
+private:
+    std::vector<Bucket, BackendAllocator<Bucket>> m_buckets;
+    std::size_t m_size;
+    double m_expectedFalsePositives;
+};
@@ -0,0 +1,282 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "puzzle.h"
+
+// Compressed storage for a single BFS level
+// Each state is packed into a compact key holding the cell index of every piece, runner in the highest bits.
+// Keys are appended to a pending run, which is sorted & delta encoded into a chunk of varints once it
+// holds chunkSize keys. Sorted neighbouring keys share their high bits, so most deltas take a few bytes
+// where a Frontier needs 2 bytes per piece & a parent index per state.
+// Chunks decode independently of each other, so consumers can stream a level in parallel, one chunk per thread.
+// Blocks of the same size are interchangeable: boards only differing by swapping them share a key.
+// Note: the order of the appended states is not kept, nor are their parents
+template <int BlockCount>
+class CompressedFrontier
+{
+public:
+    constexpr static int pieceCount = BlockCount + 1;
+
+    using Key = std::uint64_t;
+
+public:
+    CompressedFrontier(const BoardState<BlockCount> &layout, const Point &dimensions, std::size_t chunkSize = 1 << 14)
+        : m_pieces{}
+        , m_height{ dimensions.m_y }
+        , m_bitsPerPiece{ 1 }
+        , m_chunkSize{ chunkSize }
+        , m_bytes{}
+        , m_chunks{}
+        , m_pending{}
+        , m_size{ 0 }
+        , m_sorted{ true }
+        , m_lastKey{ 0 }
+    {
+        m_pieces[0] = layout.m_runner;
+        for (auto i = 0; i < BlockCount; ++i)
+        {
+            m_pieces[i + 1] = layout.m_blocks[i];
+        }
+
+        while ((1 << m_bitsPerPiece) < dimensions.m_x * dimensions.m_y)
+        {
+            ++m_bitsPerPiece;
+        }
+        if (m_bitsPerPiece * pieceCount > 64)
+        {
+            throw std::runtime_error("Board too large for compact state keys");
+        }
+    }
+
+    void push_back(const BoardState<BlockCount> &state)
+    {
+        push_back(key(state));
+    }
+
+    void push_back(Key key)
+    {
+        m_pending.push_back(key);
+        ++m_size;
+        if (m_pending.size() >= m_chunkSize)
+        {
+            seal();
+        }
+    }
+
+    // Compresses the keys appended since the last chunk, must be called before decoding the last chunk
+    void seal()
+    {
+        if (m_pending.empty())
+        {
+            return;
+        }
+
+        std::sort(begin(m_pending), end(m_pending));
+        m_sorted = m_sorted && (m_chunks.empty() || m_lastKey <= m_pending.front());
+        m_chunks.push_back(Chunk{ m_bytes.size(), m_pending.size() });
+        Key previous = 0;
+        for (const auto key : m_pending)
+        {
+            writeVarint(key - previous);
+            previous = key;
+        }
+        m_lastKey = m_pending.back();
+        m_pending.clear();
+    }
+
+    std::size_t chunkCount() const { return m_chunks.size(); }
+
+    // Replaces keys by the sorted keys of a single chunk, safe to call from several threads at once
+    void decodeChunk(std::size_t chunk, std::vector<Key> &keys) const
+    {
+        keys.resize(m_chunks[chunk].m_count);
+        auto byte = m_bytes.data() + m_chunks[chunk].m_offset;
+        Key previous = 0;
+        for (auto &key : keys)
+        {
+            Key delta = 0;
+            for (auto shift = 0; ; shift += 7)
+            {
+                delta |= static_cast<Key>(*byte & 0x7f) << shift;
+                if ((*byte++ & 0x80) == 0)
+                {
+                    break;
+                }
+            }
+            key = previous + delta;
+            previous = key;
+        }
+    }
+
+    Key key(const BoardState<BlockCount> &state) const
+    {
+        std::array<Key, BlockCount> cells{};
+        for (auto i = 0; i < BlockCount; ++i)
+        {
+            cells[i] = cell(state.m_blocks[i]);
+        }
+
+        // Interchangeable blocks in order of their cells
+        for (auto i = 0; i < BlockCount; ++i)
+        {
+            for (auto j = i + 1; j < BlockCount; ++j)
+            {
+                if (cells[j] < cells[i] && sameSize(m_pieces[i + 1], m_pieces[j + 1]))
+                {
+                    std::swap(cells[i], cells[j]);
+                }
+            }
+        }
+
+        auto result = cell(state.m_runner);
+        for (const auto cell : cells)
+        {
+            result = (result << m_bitsPerPiece) | cell;
+        }
+        return result;
+    }
+
+    // Number of significant bits of a key
+    int keyBits() const
+    {
+        return m_bitsPerPiece * pieceCount;
+    }
+
+    // Whether the chunks hold consecutive runs of the sorted level, as when keys are appended in order
+    bool sorted() const
+    {
+        return m_sorted;
+    }
+
+    // Removes the keys of this level from keys, which must be sorted & unique
+    // A single merge pass over both, decoding one chunk at a time
+    void subtractFrom(std::vector<Key> &keys) const
+    {
+        if (!m_sorted || !m_pending.empty())
+        {
+            throw std::runtime_error("Only a sealed, sorted level can be subtracted");
+        }
+
+        std::vector<Key> level;
+        auto kept = begin(keys);
+        auto candidate = begin(keys);
+        for (auto chunk = 0u; chunk < m_chunks.size() && candidate != end(keys); ++chunk)
+        {
+            decodeChunk(chunk, level);
+            for (auto known = begin(level); known != end(level) && candidate != end(keys);)
+            {
+                if (*candidate < *known)
+                {
+                    *kept++ = *candidate++;
+                }
+                else
+                {
+                    candidate += *candidate == *known ? 1 : 0;
+                    ++known;
+                }
+            }
+        }
+        kept = std::copy(candidate, end(keys), kept);
+        keys.erase(kept, end(keys));
+    }
+
+    // Rebuilds the full BoardState of a key
+    BoardState<BlockCount> state(Key key, int movesFromStart) const
+    {
+        const auto mask = (Key{ 1 } << m_bitsPerPiece) - 1;
+        std::array<Block, BlockCount> blocks{};
+        for (auto i = BlockCount - 1; i >= 0; --i)
+        {
+            blocks[i] = placed(i + 1, key & mask);
+            key >>= m_bitsPerPiece;
+        }
+        return BoardState<BlockCount>{ movesFromStart, placed(0, key & mask), std::move(blocks) };
+    }
+
+    void clear()
+    {
+        m_bytes.clear();
+        m_chunks.clear();
+        m_pending.clear();
+        m_size = 0;
+        m_sorted = true;
+        m_lastKey = 0;
+    }
+
+    void swap(CompressedFrontier &other)
+    {
+        std::swap(m_pieces, other.m_pieces);
+        std::swap(m_height, other.m_height);
+        std::swap(m_bitsPerPiece, other.m_bitsPerPiece);
+        std::swap(m_chunkSize, other.m_chunkSize);
+        std::swap(m_bytes, other.m_bytes);
+        std::swap(m_chunks, other.m_chunks);
+        std::swap(m_pending, other.m_pending);
+        std::swap(m_size, other.m_size);
+        std::swap(m_sorted, other.m_sorted);
+        std::swap(m_lastKey, other.m_lastKey);
+    }
+
+    std::size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+    // Bytes held by the level, including the keys which are not compressed yet
+    std::size_t memoryUsage() const
+    {
+        return m_bytes.size() + m_chunks.size() * sizeof(Chunk) + m_pending.size() * sizeof(Key);
+    }
+
+private:
+    struct Chunk
+    {
+        std::size_t m_offset;
+        std::size_t m_count;
+    };
+
+    Key cell(const Block &block) const
+    {
+        return static_cast<Key>(block.m_startX * m_height + block.m_startY);
+    }
+
+    static bool sameSize(const Block &left, const Block &right)
+    {
+        return left.m_sizeX == right.m_sizeX && left.m_sizeY == right.m_sizeY;
+    }
+
+    Block placed(int piece, Key cell) const
+    {
+        const auto &block = m_pieces[piece];
+        return Block{ static_cast<int>(cell) / m_height, static_cast<int>(cell) % m_height, block.m_sizeX, block.m_sizeY, block.id };
+    }
+
+    // 7 bits per byte, high bit set on all but the last byte
+    void writeVarint(Key value)
+    {
+        while (value >= 0x80)
+        {
+            m_bytes.push_back(static_cast<std::uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        m_bytes.push_back(static_cast<std::uint8_t>(value));
+    }
+
+private:
+    std::array<Block, pieceCount> m_pieces;
+    int m_height;
+    int m_bitsPerPiece;
+    std::size_t m_chunkSize;
+
+    std::vector<std::uint8_t> m_bytes;
+    std::vector<Chunk> m_chunks;
+    std::vector<Key> m_pending;
+    std::size_t m_size;
+
+    // Every chunk starts at or after the last key of the previous one
+    bool m_sorted;
+    Key m_lastKey;
+};
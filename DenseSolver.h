@@ -0,0 +1,199 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "MoveDiscovery.h"
+#include "PlacementRanking.h"
+#include "solver.h"
+
+struct DenseResult
+{
+    // Number of moves to the goal, -1 if it can't be reached (or wasn't reached, when not exhaustive)
+    int m_distance;
+
+    // Deepest level containing states
+    int m_depth;
+
+    // Number of states reached, including the initial state
+    std::uint64_t m_reachedStates;
+};
+
+// Level-synchronous search over the dense ranks of PlacementRanking, instead of a hash table
+// Every layout has 2 bits: unseen, current level, next level or closed. Each level is expanded by
+// scanning the bits in order, split over threads by range; children are marked with an atomic
+// compare & swap on the word holding their bits. Between levels, a single pass turns the current level
+// into closed states & the next level into the current one.
+template <
+    int BlockCount,
+    typename MoveDiscovery
+>
+class DenseSolver
+{
+public:
+    explicit DenseSolver(const Puzzle<BlockCount> &puzzle)
+        : m_puzzle{ puzzle }
+        , m_ranking{ puzzle }
+        , m_words{}
+    {
+    }
+
+    // Stops at the level reaching the goal, unless exhaustive: then every reachable layout is visited
+    DenseResult solve(unsigned threads = std::thread::hardware_concurrency(), bool exhaustive = false)
+    {
+        threads = std::max(threads, 1u);
+        const auto wordCount = static_cast<std::size_t>((m_ranking.size() + statesPerWord - 1) / statesPerWord);
+        m_words.reset(new std::atomic<std::uint64_t>[wordCount]);
+        for (auto word = 0u; word < wordCount; ++word)
+        {
+            m_words[word].store(0, std::memory_order_relaxed);
+        }
+
+        DenseResult result{ -1, 0, 1 };
+        if (isSolution(m_puzzle.m_initialState, m_puzzle.m_goal))
+        {
+            result.m_distance = 0;
+            if (!exhaustive)
+            {
+                return result;
+            }
+        }
+        mark(m_ranking.rank(m_puzzle.m_initialState), current);
+
+        for (auto depth = 0; ; ++depth)
+        {
+            std::atomic<bool> solved{ false };
+            const auto expand = [&](std::size_t firstWord, std::size_t lastWord)
+            {
+                for (auto word = firstWord; word < lastWord; ++word)
+                {
+                    const auto bits = m_words[word].load(std::memory_order_relaxed);
+                    auto currentStates = bits & ~(bits >> 1) & lowBits;
+                    while (currentStates != 0)
+                    {
+                        const auto slot = trailingZeros(currentStates) / 2;
+                        currentStates &= currentStates - 1;
+
+                        const auto rank = word * statesPerWord + slot;
+                        const auto state = std::make_shared<BoardState<BlockCount>>(m_ranking.unrank(rank, depth));
+                        for (auto &move : MoveDiscovery::gatherMoves(m_puzzle.m_dimensions, state, m_puzzle.m_forbiddenSpots))
+                        {
+                            if (movesRunnerToGoal(move, m_puzzle.m_goal))
+                            {
+                                solved = true;
+                            }
+                            markIfUnseen(m_ranking.rank(move()));
+                        }
+                    }
+                }
+            };
+
+            std::vector<std::thread> workers;
+            const auto wordsPerThread = (wordCount + threads - 1) / threads;
+            for (auto thread = 1u; thread < threads; ++thread)
+            {
+                workers.emplace_back(expand, std::min(wordCount, thread * wordsPerThread), std::min(wordCount, (thread + 1) * wordsPerThread));
+            }
+            expand(0, std::min(wordCount, wordsPerThread));
+            for (auto &worker : workers)
+            {
+                worker.join();
+            }
+
+            if (solved && result.m_distance < 0)
+            {
+                result.m_distance = depth + 1;
+                if (!exhaustive)
+                {
+                    return result;
+                }
+            }
+
+            // current -> closed, next -> current
+            std::uint64_t reached = 0;
+            for (auto word = 0u; word < wordCount; ++word)
+            {
+                const auto bits = m_words[word].load(std::memory_order_relaxed);
+                const auto low = bits & lowBits;
+                const auto high = (bits >> 1) & lowBits;
+                reached += popCount(high & ~low);
+                m_words[word].store(low | high | (low << 1), std::memory_order_relaxed);
+            }
+            if (reached == 0)
+            {
+                return result;
+            }
+            result.m_depth = depth + 1;
+            result.m_reachedStates += reached;
+        }
+    }
+
+    // Bytes used by the level bits
+    std::size_t memoryUsage() const
+    {
+        return static_cast<std::size_t>((m_ranking.size() + statesPerWord - 1) / statesPerWord) * sizeof(std::uint64_t);
+    }
+
+    const PlacementRanking<BlockCount> &ranking() const
+    {
+        return m_ranking;
+    }
+
+private:
+    constexpr static std::uint64_t statesPerWord = 32;
+    constexpr static std::uint64_t lowBits = 0x5555'5555'5555'5555ULL;
+
+    // 2 bits per state, low bit first
+    constexpr static std::uint64_t current = 1;
+    constexpr static std::uint64_t next = 2;
+
+    static int trailingZeros(std::uint64_t bits)
+    {
+        auto count = 0;
+        for (; (bits & 1) == 0; bits >>= 1)
+        {
+            ++count;
+        }
+        return count;
+    }
+
+    static std::uint64_t popCount(std::uint64_t bits)
+    {
+        std::uint64_t count = 0;
+        for (; bits != 0; bits &= bits - 1)
+        {
+            ++count;
+        }
+        return count;
+    }
+
+    void mark(std::uint64_t rank, std::uint64_t value)
+    {
+        m_words[rank / statesPerWord].fetch_or(value << (2 * (rank % statesPerWord)));
+    }
+
+    void markIfUnseen(std::uint64_t rank)
+    {
+        auto &word = m_words[rank / statesPerWord];
+        const auto shift = 2 * (rank % statesPerWord);
+        auto bits = word.load(std::memory_order_relaxed);
+        while (((bits >> shift) & 3) == 0 && !word.compare_exchange_weak(bits, bits | (next << shift), std::memory_order_relaxed))
+        {
+        }
+    }
+
+private:
+    const Puzzle<BlockCount> m_puzzle;
+    PlacementRanking<BlockCount> m_ranking;
+    std::unique_ptr<std::atomic<std::uint64_t>[]> m_words;
+};
+
+template <int BlockCount, typename MoveDiscovery = MoveRunnerFirst<>>
+DenseSolver<BlockCount, MoveDiscovery> makeDenseSolver(const Puzzle<BlockCount> &puzzle)
+{
+    return DenseSolver<BlockCount, MoveDiscovery>{ puzzle };
+}
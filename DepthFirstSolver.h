@@ -0,0 +1,117 @@
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "Heuristics.h"
+#include "MovePruning.h"
+#include "solver.h"
+
+// Iterative deepening A*: depth-first searches bounded by moves made + heuristic, raising the bound
+// to the lowest estimate which exceeded it until the goal is found.
+// Only the current path is kept in memory, so repeated boards are never detected: the pruning policy
+// (see MovePruning.h) is all that keeps the branching factor down.
+template <
+    int BlockCount,
+    typename Pruning = MovePruning<>,
+    typename Heuristic = RunnerManhattanDistance
+>
+class DepthFirstSolver
+{
+public:
+    explicit DepthFirstSolver(const Puzzle<BlockCount> &puzzle, Heuristic heuristic = Heuristic{})
+        : m_puzzle{ puzzle }
+        , m_heuristic{ heuristic }
+        , m_path{}
+        , m_expanded{ 0 }
+    {
+    }
+
+    // Stops with OutOfBudget once the bound would exceed maxDistance
+    SearchResult solve(int maxDistance = 64)
+    {
+        m_expanded = 0;
+        m_path.clear();
+
+        const auto initial = std::make_shared<BoardState<BlockCount>>(m_puzzle.m_initialState);
+        for (auto bound = m_heuristic(*initial, m_puzzle.m_goal); ; )
+        {
+            if (bound > maxDistance)
+            {
+                return SearchResult{ SearchStatus::OutOfBudget, maxDistance, m_expanded };
+            }
+
+            const auto next = search(initial, 0, bound, MoveHistory{});
+            if (next == found)
+            {
+                m_path = std::vector<BoardState<BlockCount>>(m_path.rbegin(), m_path.rend());
+                return SearchResult{ SearchStatus::Solved, static_cast<int>(m_path.size()) - 1, m_expanded };
+            }
+            if (next == exhausted)
+            {
+                return SearchResult{ SearchStatus::Unsolvable, -1, m_expanded };
+            }
+            bound = next;
+        }
+    }
+
+    // All states from the initial state up to & including the solution of the last solve
+    const std::vector<BoardState<BlockCount>> &path() const
+    {
+        return m_path;
+    }
+
+    std::size_t expandedStates() const
+    {
+        return m_expanded;
+    }
+
+private:
+    constexpr static int found = -1;
+    constexpr static int exhausted = std::numeric_limits<int>::max();
+
+    // Returns found, or the lowest estimate beyond bound of the boards below state
+    int search(const std::shared_ptr<BoardState<BlockCount>> &state, int depth, int bound, const MoveHistory &history)
+    {
+        const auto estimate = depth + m_heuristic(*state, m_puzzle.m_goal);
+        if (estimate > bound)
+        {
+            return estimate;
+        }
+        if (isSolution(*state, m_puzzle.m_goal))
+        {
+            m_path.push_back(*state);
+            return found;
+        }
+
+        ++m_expanded;
+        auto next = exhausted;
+        for (auto &move : Pruning::gatherMoves(m_puzzle.m_dimensions, state, m_puzzle.m_forbiddenSpots, history))
+        {
+            const auto child = std::make_shared<BoardState<BlockCount>>(move.m_move());
+            const auto result = search(child, depth + 1, bound, move.m_history);
+            if (result == found)
+            {
+                // Path is built backwards on the way up, see solve()
+                m_path.push_back(*state);
+                return found;
+            }
+            next = std::min(next, result);
+        }
+        return next;
+    }
+
+private:
+    const Puzzle<BlockCount> m_puzzle;
+    Heuristic m_heuristic;
+    std::vector<BoardState<BlockCount>> m_path;
+    std::size_t m_expanded;
+};
+
+template <int BlockCount, typename Pruning = MovePruning<>>
+DepthFirstSolver<BlockCount, Pruning> makeDepthFirstSolver(const Puzzle<BlockCount> &puzzle)
+{
+    return DepthFirstSolver<BlockCount, Pruning>{ puzzle };
+}
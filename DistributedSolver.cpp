@@ -0,0 +1,147 @@
+#include "DistributedSolver.h"
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace
+{
+    std::runtime_error systemError(const char *what)
+    {
+        return std::runtime_error(std::string(what) + ": " + std::strerror(errno));
+    }
+}
+
+Channel::Channel(int descriptor)
+    : m_descriptor{ descriptor }
+{
+}
+
+Channel::~Channel()
+{
+    close();
+}
+
+Channel::Channel(Channel &&other) noexcept
+    : m_descriptor{ other.m_descriptor }
+{
+    other.m_descriptor = -1;
+}
+
+Channel &Channel::operator=(Channel &&other) noexcept
+{
+    if (this != &other)
+    {
+        close();
+        m_descriptor = other.m_descriptor;
+        other.m_descriptor = -1;
+    }
+    return *this;
+}
+
+std::pair<Channel, Channel> Channel::pair()
+{
+    int descriptors[2];
+    if (::socketpair(AF_UNIX, SOCK_STREAM, 0, descriptors) != 0)
+    {
+        throw systemError("socketpair");
+    }
+    return std::make_pair(Channel{ descriptors[0] }, Channel{ descriptors[1] });
+}
+
+void Channel::send(const void *data, std::size_t size)
+{
+    const auto bytes = static_cast<const char *>(data);
+    for (std::size_t written = 0; written < size;)
+    {
+        // A worker which is gone must surface as an exception, not as SIGPIPE
+        const auto result = ::send(m_descriptor, bytes + written, size - written, MSG_NOSIGNAL);
+        if (result < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (result <= 0)
+        {
+            throw systemError("Channel send");
+        }
+        written += static_cast<std::size_t>(result);
+    }
+}
+
+void Channel::receive(void *data, std::size_t size)
+{
+    const auto bytes = static_cast<char *>(data);
+    for (std::size_t received = 0; received < size;)
+    {
+        const auto result = ::read(m_descriptor, bytes + received, size - received);
+        if (result < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (result == 0)
+        {
+            throw std::runtime_error("Channel closed by the other end");
+        }
+        if (result < 0)
+        {
+            throw systemError("Channel receive");
+        }
+        received += static_cast<std::size_t>(result);
+    }
+}
+
+void Channel::close()
+{
+    if (m_descriptor >= 0)
+    {
+        ::close(m_descriptor);
+        m_descriptor = -1;
+    }
+}
+
+namespace detail
+{
+    int spawn(const std::function<void()> &work)
+    {
+        const auto process = ::fork();
+        if (process < 0)
+        {
+            throw systemError("fork");
+        }
+        if (process == 0)
+        {
+            // Never return into the caller's stack, it belongs to the parent
+            auto status = 0;
+            try
+            {
+                work();
+            }
+            catch (...)
+            {
+                status = 1;
+            }
+            ::_exit(status);
+        }
+        return process;
+    }
+
+    void join(const std::vector<int> &processes)
+    {
+        auto failed = false;
+        for (const auto process : processes)
+        {
+            int status = 0;
+            while (::waitpid(process, &status, 0) < 0 && errno == EINTR)
+            {
+            }
+            failed = failed || !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+        }
+        if (failed)
+        {
+            throw std::runtime_error("Worker process failed");
+        }
+    }
+}
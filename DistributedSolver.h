@@ -0,0 +1,357 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "BoardHasher.h"
+#include "CompressedFrontier.h"
+#include "MoveDiscovery.h"
+#include "VisitedSet.h"
+#include "solver.h"
+
+// Blocking byte stream over one end of a unix socket pair, closed when destroyed
+// Throws std::runtime_error when the other end is gone
+class Channel
+{
+public:
+    explicit Channel(int descriptor = -1);
+    ~Channel();
+
+    Channel(Channel &&other) noexcept;
+    Channel &operator=(Channel &&other) noexcept;
+    Channel(const Channel &) = delete;
+    Channel &operator=(const Channel &) = delete;
+
+    // Both ends of a new socket pair
+    static std::pair<Channel, Channel> pair();
+
+    void send(const void *data, std::size_t size);
+    void receive(void *data, std::size_t size);
+    void close();
+
+    template <typename T>
+    void send(const T &value)
+    {
+        send(&value, sizeof(T));
+    }
+
+    template <typename T>
+    T receive()
+    {
+        T value{};
+        receive(&value, sizeof(T));
+        return value;
+    }
+
+    template <typename T>
+    void sendVector(const std::vector<T> &values)
+    {
+        send(static_cast<std::uint64_t>(values.size()));
+        send(values.data(), values.size() * sizeof(T));
+    }
+
+    template <typename T>
+    void receiveVector(std::vector<T> &values)
+    {
+        values.resize(static_cast<std::size_t>(receive<std::uint64_t>()));
+        receive(values.data(), values.size() * sizeof(T));
+    }
+
+private:
+    int m_descriptor;
+};
+
+namespace detail
+{
+    // Forks a worker process running work, which exits the process when done
+    // Returns the process id of the worker
+    int spawn(const std::function<void()> &work);
+
+    // Waits for every worker, throws if one of them failed
+    void join(const std::vector<int> &processes);
+}
+
+struct DistributedStats
+{
+    unsigned m_workers;
+
+    // Number of moves to the goal, -1 if it can't be reached
+    int m_distance;
+
+    std::size_t m_expandedStates;
+
+    // States sent to the worker owning them, as opposed to states owned by the worker generating them
+    std::size_t m_sentStates;
+
+    std::chrono::milliseconds m_time;
+};
+
+// Level-synchronous search spread over worker processes
+// Boards are partitioned by hash: every worker only keeps the visited boards & the frontier it owns.
+// Children generated by a worker are batched per owner & sent over a socket pair between each two workers.
+// After every level each worker reports to the parent process, which acts as the level barrier:
+// the search stops at the first level containing the goal, or when no worker has new boards left.
+// Note: workers are forked, so they share the hash codes of the parent without sending them
+template <
+    int BlockCount,
+    typename MoveDiscovery
+>
+class DistributedSolver
+{
+public:
+    using Key = typename CompressedFrontier<BlockCount>::Key;
+
+public:
+    DistributedSolver(const Puzzle<BlockCount> &puzzle, unsigned workers)
+        : m_puzzle{ puzzle }
+        , m_hasher{ puzzle }
+        , m_workers{ std::max(workers, 1u) }
+    {
+    }
+
+    DistributedStats solve()
+    {
+        const auto startTime = std::chrono::steady_clock::now();
+        DistributedStats stats{ m_workers, 0, 0, 0, std::chrono::milliseconds{ 0 } };
+        if (isSolution(m_puzzle.m_initialState, m_puzzle.m_goal))
+        {
+            return stats;
+        }
+
+        // Every worker has a channel to the parent & one to each other worker
+        std::vector<Channel> parentEnds;
+        std::vector<Channel> workerEnds;
+        std::vector<std::vector<Channel>> peers(m_workers);
+        for (auto worker = 0u; worker < m_workers; ++worker)
+        {
+            auto control = Channel::pair();
+            parentEnds.push_back(std::move(control.first));
+            workerEnds.push_back(std::move(control.second));
+            peers[worker].resize(m_workers);
+        }
+        for (auto first = 0u; first < m_workers; ++first)
+        {
+            for (auto second = first + 1; second < m_workers; ++second)
+            {
+                auto peer = Channel::pair();
+                peers[first][second] = std::move(peer.first);
+                peers[second][first] = std::move(peer.second);
+            }
+        }
+
+        std::vector<int> processes;
+        for (auto worker = 0u; worker < m_workers; ++worker)
+        {
+            processes.push_back(detail::spawn([&]()
+            {
+                parentEnds.clear();
+                for (auto other = 0u; other < m_workers; ++other)
+                {
+                    if (other != worker)
+                    {
+                        workerEnds[other].close();
+                        peers[other].clear();
+                    }
+                }
+                work(worker, workerEnds[worker], peers[worker]);
+            }));
+        }
+        workerEnds.clear();
+        peers.clear();
+
+        try
+        {
+            stats.m_distance = coordinate(parentEnds);
+            for (auto &worker : parentEnds)
+            {
+                stats.m_expandedStates += static_cast<std::size_t>(worker.receive<std::uint64_t>());
+                stats.m_sentStates += static_cast<std::size_t>(worker.receive<std::uint64_t>());
+            }
+        }
+        catch (...)
+        {
+            // Closing the channels makes the remaining workers fail as well, so they can be reaped
+            parentEnds.clear();
+            try
+            {
+                detail::join(processes);
+            }
+            catch (...)
+            {
+            }
+            throw;
+        }
+        detail::join(processes);
+
+        stats.m_time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
+        return stats;
+    }
+
+private:
+    // Level barrier, returns the distance to the goal
+    int coordinate(std::vector<Channel> &workers)
+    {
+        for (auto depth = 0; ; ++depth)
+        {
+            auto solved = false;
+            std::uint64_t frontierSize = 0;
+            for (auto &worker : workers)
+            {
+                solved = worker.receive<std::uint8_t>() != 0 || solved;
+                frontierSize += worker.receive<std::uint64_t>();
+            }
+
+            const auto stop = solved || frontierSize == 0;
+            for (auto &worker : workers)
+            {
+                worker.send(static_cast<std::uint8_t>(stop ? 1 : 0));
+            }
+            if (stop)
+            {
+                return solved ? depth + 1 : -1;
+            }
+        }
+    }
+
+    unsigned ownerOf(int hash) const
+    {
+        return static_cast<unsigned>(hash) % m_workers;
+    }
+
+    // Runs in the worker process
+    void work(unsigned self, Channel &parent, std::vector<Channel> &peers)
+    {
+        VisitedSet<> visited{};
+        CompressedFrontier<BlockCount> frontier{ m_puzzle.m_initialState, m_puzzle.m_dimensions };
+        CompressedFrontier<BlockCount> next{ m_puzzle.m_initialState, m_puzzle.m_dimensions };
+        const auto initialHash = m_hasher.hash(m_puzzle.m_initialState);
+        if (ownerOf(initialHash) == self)
+        {
+            visited.insert(initialHash, 0);
+            frontier.push_back(m_puzzle.m_initialState);
+            frontier.seal();
+        }
+
+        std::vector<std::vector<Key>> outgoingKeys(m_workers);
+        std::vector<std::vector<int>> outgoingHashes(m_workers);
+        std::vector<Key> keys;
+        std::vector<int> hashes;
+        std::vector<char> isNew;
+        std::uint64_t expanded = 0;
+        std::uint64_t sent = 0;
+
+        // Only newly found boards go to the next level
+        const auto visit = [&](const std::vector<Key> &childKeys, const std::vector<int> &childHashes, int depth)
+        {
+            isNew.resize(childHashes.size());
+            visited.insert(childHashes.data(), childHashes.size(), depth, isNew.data());
+            for (auto i = 0u; i < childKeys.size(); ++i)
+            {
+                if (isNew[i])
+                {
+                    next.push_back(childKeys[i]);
+                }
+            }
+        };
+
+        for (auto depth = 0; ; ++depth)
+        {
+            auto solved = false;
+            for (auto chunk = 0u; chunk < frontier.chunkCount() && !solved; ++chunk)
+            {
+                frontier.decodeChunk(chunk, keys);
+                for (auto i = 0u; i < keys.size() && !solved; ++i, ++expanded)
+                {
+                    const auto state = std::make_shared<BoardState<BlockCount>>(frontier.state(keys[i], depth));
+                    for (auto &move : MoveDiscovery::gatherMoves(m_puzzle.m_dimensions, state, m_puzzle.m_forbiddenSpots))
+                    {
+                        if (movesRunnerToGoal(move, m_puzzle.m_goal))
+                        {
+                            solved = true;
+                            break;
+                        }
+                        const auto child = move();
+                        const auto hash = m_hasher.hash(child);
+                        outgoingKeys[ownerOf(hash)].push_back(next.key(child));
+                        outgoingHashes[ownerOf(hash)].push_back(hash);
+                    }
+                }
+            }
+
+            // Sending happens on its own thread, so workers sending to each other at once can't block on full sockets
+            std::exception_ptr sendFailure;
+            std::thread sender{ [&]()
+            {
+                try
+                {
+                    for (auto peer = 0u; peer < m_workers; ++peer)
+                    {
+                        if (peer != self)
+                        {
+                            peers[peer].sendVector(outgoingKeys[peer]);
+                            peers[peer].sendVector(outgoingHashes[peer]);
+                        }
+                    }
+                }
+                catch (...)
+                {
+                    sendFailure = std::current_exception();
+                }
+            } };
+
+            visit(outgoingKeys[self], outgoingHashes[self], depth + 1);
+            for (auto peer = 0u; peer < m_workers; ++peer)
+            {
+                if (peer != self)
+                {
+                    peers[peer].receiveVector(keys);
+                    peers[peer].receiveVector(hashes);
+                    visit(keys, hashes, depth + 1);
+                }
+            }
+            sender.join();
+            if (sendFailure)
+            {
+                std::rethrow_exception(sendFailure);
+            }
+
+            for (auto peer = 0u; peer < m_workers; ++peer)
+            {
+                sent += peer != self ? outgoingKeys[peer].size() : 0;
+                outgoingKeys[peer].clear();
+                outgoingHashes[peer].clear();
+            }
+            next.seal();
+            frontier.swap(next);
+            next.clear();
+
+            parent.send(static_cast<std::uint8_t>(solved ? 1 : 0));
+            parent.send(static_cast<std::uint64_t>(frontier.size()));
+            if (parent.receive<std::uint8_t>() != 0)
+            {
+                break;
+            }
+        }
+
+        parent.send(expanded);
+        parent.send(sent);
+    }
+
+private:
+    const Puzzle<BlockCount> m_puzzle;
+    BoardHasher<> m_hasher;
+    const unsigned m_workers;
+};
+
+template <int BlockCount, typename MoveDiscovery = MoveRunnerFirst<>>
+DistributedSolver<BlockCount, MoveDiscovery> makeDistributedSolver(const Puzzle<BlockCount> &puzzle, unsigned workers)
+{
+    return DistributedSolver<BlockCount, MoveDiscovery>{ puzzle, workers };
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "puzzle.h"
+
+// Deterministic identity of a puzzle, stable across runs & processes (unlike BoardHasher's random codes)
+// Covers the dimensions, forbidden spots, goal & initial layout. Blocks of the same size are interchangeable
+// and a puzzle & its left-right mirror image share a fingerprint: the smallest of both descriptions is used.
+struct PuzzleFingerprint
+{
+    // FNV-1a hash of m_description
+    std::uint64_t m_value;
+
+    // Canonical description the fingerprint was computed from, to tell apart colliding fingerprints
+    std::vector<int> m_description;
+
+    // Whether the canonical description describes the mirror image of the puzzle
+    bool m_mirrored;
+};
+
+namespace detail
+{
+    // FNV-1a hash over the bytes of numbers, least significant byte first
+    inline std::uint64_t fnv1a(const std::vector<int> &numbers)
+    {
+        std::uint64_t value = 14695981039346656037ull;
+        for (const auto number : numbers)
+        {
+            for (auto byte = 0; byte < 4; ++byte)
+            {
+                value ^= (static_cast<std::uint32_t>(number) >> (8 * byte)) & 0xff;
+                value *= 1099511628211ull;
+            }
+        }
+        return value;
+    }
+
+    // dims, forbidden spots, goal, runner, blocks; spots & blocks sorted so their order doesn't matter
+    template <int BlockCount>
+    std::vector<int> describe(const Puzzle<BlockCount> &puzzle, bool mirrored)
+    {
+        const auto width = puzzle.m_dimensions.m_x;
+        const auto x = [&](int startX, int sizeX) { return mirrored ? width - startX - sizeX : startX; };
+
+        std::vector<int> description{ width, puzzle.m_dimensions.m_y, static_cast<int>(puzzle.m_forbiddenSpots.size()), BlockCount };
+
+        std::vector<std::array<int, 2>> spots;
+        for (const auto &spot : puzzle.m_forbiddenSpots)
+        {
+            spots.push_back({ x(spot.m_x, 1), spot.m_y });
+        }
+        std::sort(begin(spots), end(spots));
+        for (const auto &spot : spots)
+        {
+            description.insert(end(description), begin(spot), end(spot));
+        }
+
+        // Only the start of the goal is compared with the runner's (see isSolution), so the goal is described
+        // as the footprint of the runner there, whatever the size of the goal block
+        const auto &goal = puzzle.m_goal;
+        const auto &runner = puzzle.m_initialState.m_runner;
+        description.insert(end(description), { x(goal.m_startX, runner.m_sizeX), goal.m_startY, runner.m_sizeX, runner.m_sizeY });
+        description.insert(end(description), { x(runner.m_startX, runner.m_sizeX), runner.m_startY, runner.m_sizeX, runner.m_sizeY });
+
+        std::vector<std::array<int, 4>> blocks;
+        for (const auto &block : puzzle.m_initialState.m_blocks)
+        {
+            blocks.push_back({ block.m_sizeX, block.m_sizeY, x(block.m_startX, block.m_sizeX), block.m_startY });
+        }
+        std::sort(begin(blocks), end(blocks));
+        for (const auto &block : blocks)
+        {
+            description.insert(end(description), begin(block), end(block));
+        }
+
+        return description;
+    }
+}
+
+template <int BlockCount>
+PuzzleFingerprint fingerprint(const Puzzle<BlockCount> &puzzle)
+{
+    auto description = detail::describe(puzzle, false);
+    auto mirroredDescription = detail::describe(puzzle, true);
+    const auto mirrored = mirroredDescription < description;
+    if (mirrored)
+    {
+        description.swap(mirroredDescription);
+    }
+
+    const auto value = detail::fnv1a(description);
+    return PuzzleFingerprint{ value, std::move(description), mirrored };
+}
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+#include "MemoryBackend.h"
+#include "puzzle.h"
+#include "Serialization.h"
+
+// Structure-of-arrays storage for a single BFS level
+// Every piece keeps its own x & y column, so work over a whole level (hashing, dedup)
+// runs as flat loops over contiguous memory instead of chasing heap allocated BoardStates.
+// Sizes & ids of the pieces never change during a solve, so they are only stored once.
+// Piece 0 is the runner, piece i + 1 is m_blocks[i]
+// Each state also records the index of its parent in the previous level, for rebuilding paths
+template <int BlockCount>
+class Frontier
+{
+public:
+    constexpr static int pieceCount = BlockCount + 1;
+
+    // Note: assumes boards are no larger than 127 in either dimension
+    using Coordinate = std::int8_t;
+    using Column = std::vector<Coordinate, BackendAllocator<Coordinate>>;
+    using Index = std::uint32_t;
+
+public:
+    // Columns & parents come from memory, or from operator new without a backend
+    explicit Frontier(const BoardState<BlockCount> &layout, std::shared_ptr<MemoryBackend> memory = nullptr)
+        : m_pieces{}
+        , m_xs{}
+        , m_ys{}
+        , m_parents{ BackendAllocator<Index>{ memory } }
+    {
+        for (auto piece = 0; piece < pieceCount; ++piece)
+        {
+            m_xs[piece] = Column{ BackendAllocator<Coordinate>{ memory } };
+            m_ys[piece] = Column{ BackendAllocator<Coordinate>{ memory } };
+        }
+
+        m_pieces[0] = layout.m_runner;
+        for (auto i = 0; i < BlockCount; ++i)
+        {
+            m_pieces[i + 1] = layout.m_blocks[i];
+        }
+    }
+
+    void push_back(const BoardState<BlockCount> &state, Index parent = 0)
+    {
+        m_parents.push_back(parent);
+        m_xs[0].push_back(static_cast<Coordinate>(state.m_runner.m_startX));
+        m_ys[0].push_back(static_cast<Coordinate>(state.m_runner.m_startY));
+        for (auto i = 0; i < BlockCount; ++i)
+        {
+            m_xs[i + 1].push_back(static_cast<Coordinate>(state.m_blocks[i].m_startX));
+            m_ys[i + 1].push_back(static_cast<Coordinate>(state.m_blocks[i].m_startY));
+        }
+    }
+
+    // Rebuilds the full BoardState stored at index
+    BoardState<BlockCount> at(std::size_t index, int movesFromStart) const
+    {
+        std::array<Block, BlockCount> blocks{};
+        for (auto i = 0; i < BlockCount; ++i)
+        {
+            blocks[i] = placed(i + 1, index);
+        }
+        return BoardState<BlockCount>{ movesFromStart, placed(0, index), std::move(blocks) };
+    }
+
+    // Drops every state for which keep[index] == 0, preserving the order of the others
+    void compact(const std::vector<char> &keep)
+    {
+        for (auto piece = 0; piece < pieceCount; ++piece)
+        {
+            compactColumn(m_xs[piece], keep);
+            compactColumn(m_ys[piece], keep);
+        }
+        compactColumn(m_parents, keep);
+    }
+
+    void reserve(std::size_t count)
+    {
+        for (auto piece = 0; piece < pieceCount; ++piece)
+        {
+            m_xs[piece].reserve(count);
+            m_ys[piece].reserve(count);
+        }
+        m_parents.reserve(count);
+    }
+
+    void clear()
+    {
+        for (auto piece = 0; piece < pieceCount; ++piece)
+        {
+            m_xs[piece].clear();
+            m_ys[piece].clear();
+        }
+        m_parents.clear();
+    }
+
+    void swap(Frontier &other)
+    {
+        std::swap(m_pieces, other.m_pieces);
+        std::swap(m_xs, other.m_xs);
+        std::swap(m_ys, other.m_ys);
+        std::swap(m_parents, other.m_parents);
+    }
+
+    // Note: only positions & parents are written, the layout is provided when constructing the frontier
+    void write(std::ostream &out) const
+    {
+        serialization::write(out, pieceCount);
+        for (auto piece = 0; piece < pieceCount; ++piece)
+        {
+            serialization::writeVector(out, m_xs[piece]);
+            serialization::writeVector(out, m_ys[piece]);
+        }
+        serialization::writeVector(out, m_parents);
+    }
+
+    void read(std::istream &in)
+    {
+        serialization::expect(in, pieceCount, "number of pieces");
+        for (auto piece = 0; piece < pieceCount; ++piece)
+        {
+            serialization::readVector(in, m_xs[piece]);
+            serialization::readVector(in, m_ys[piece]);
+        }
+        serialization::readVector(in, m_parents);
+    }
+
+    std::size_t size() const { return m_xs[0].size(); }
+    bool empty() const { return m_xs[0].empty(); }
+
+    // Size & id of a piece, position as in the layout the frontier was created from
+    const Block &piece(int piece) const { return m_pieces[piece]; }
+
+    const Column &xs(int piece) const { return m_xs[piece]; }
+    const Column &ys(int piece) const { return m_ys[piece]; }
+    Index parent(std::size_t index) const { return m_parents[index]; }
+
+private:
+    Block placed(int piece, std::size_t index) const
+    {
+        const auto &block = m_pieces[piece];
+        return Block{ m_xs[piece][index], m_ys[piece][index], block.m_sizeX, block.m_sizeY, block.id };
+    }
+
+    template <typename Values>
+    static void compactColumn(Values &column, const std::vector<char> &keep)
+    {
+        auto kept = 0u;
+        for (auto i = 0u; i < column.size(); ++i)
+        {
+            column[kept] = column[i];
+            kept += keep[i] ? 1 : 0;
+        }
+        column.resize(kept);
+    }
+
+private:
+    std::array<Block, pieceCount> m_pieces;
+    std::array<Column, pieceCount> m_xs;
+    std::array<Column, pieceCount> m_ys;
+    std::vector<Index, BackendAllocator<Index>> m_parents;
+};
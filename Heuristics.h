@@ -0,0 +1,106 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "PatternDatabase.h"
+#include "puzzle.h"
+
+// Lower bounds on the number of moves still needed to solve a board
+// Every heuristic is admissible: it never overestimates the remaining number of moves
+
+// Number of steps the runner needs to reach the goal on an otherwise empty board
+// Every move shifts the runner by at most one cell
+struct RunnerManhattanDistance
+{
+    template <int BlockCount>
+    int operator()(const BoardState<BlockCount> &state, const Block &goal) const
+    {
+        return std::abs(state.m_runner.m_startX - goal.m_startX)
+            + std::abs(state.m_runner.m_startY - goal.m_startY);
+    }
+};
+
+enum class PatternCombination
+{
+    // Largest bound of all databases
+    Max,
+
+    // Sum of the bounds, only valid for databases with disjoint blocks of which at most one counts runner moves
+    Additive,
+};
+
+// Combines the lower bounds of several pattern databases of the same board family
+template <int BlockCount>
+class PatternDatabaseHeuristic
+{
+public:
+    using Database = PatternDatabase<BlockCount>;
+
+public:
+    PatternDatabaseHeuristic(std::vector<std::shared_ptr<const Database>> databases, PatternCombination combination)
+        : m_databases{ std::move(databases) }
+        , m_combination{ combination }
+    {
+        if (m_combination == PatternCombination::Additive && !additive())
+        {
+            throw std::runtime_error("Pattern databases can't be added up");
+        }
+    }
+
+    int operator()(const BoardState<BlockCount> &state, const Block &) const
+    {
+        auto result = 0;
+        for (const auto &database : m_databases)
+        {
+            const auto bound = (*database)(state);
+            if (bound == Database::unreachable)
+            {
+                return bound;
+            }
+            result = m_combination == PatternCombination::Additive ? result + bound : std::max(result, bound);
+        }
+        return result;
+    }
+
+private:
+    // Every move is counted by at most one of the databases
+    bool additive() const
+    {
+        std::vector<int> blocks;
+        auto runnerCounted = 0;
+        for (const auto &database : m_databases)
+        {
+            runnerCounted += database->countsRunnerMoves() ? 1 : 0;
+            blocks.insert(end(blocks), begin(database->blocks()), end(database->blocks()));
+        }
+        std::sort(begin(blocks), end(blocks));
+        return runnerCounted <= 1 && std::adjacent_find(begin(blocks), end(blocks)) == end(blocks);
+    }
+
+private:
+    std::vector<std::shared_ptr<const Database>> m_databases;
+    PatternCombination m_combination;
+};
+
+// Builds (or reads from cacheDirectory) a database for every pattern of blocks & combines them
+// When adding up, only the database of the first pattern counts runner moves
+template <int BlockCount>
+PatternDatabaseHeuristic<BlockCount> makePatternDatabaseHeuristic(
+    const Puzzle<BlockCount> &puzzle,
+    const std::vector<std::vector<int>> &patterns,
+    PatternCombination combination,
+    const std::string &cacheDirectory = {})
+{
+    std::vector<std::shared_ptr<const PatternDatabase<BlockCount>>> databases;
+    for (const auto &pattern : patterns)
+    {
+        const auto countsRunnerMoves = combination == PatternCombination::Max || databases.empty();
+        databases.push_back(std::make_shared<const PatternDatabase<BlockCount>>(puzzle, pattern, countsRunnerMoves, cacheDirectory));
+    }
+    return PatternDatabaseHeuristic<BlockCount>{ std::move(databases), combination };
+}
@@ -0,0 +1,202 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "BoardHasher.h"
+#include "Frontier.h"
+#include "MoveDiscovery.h"
+#include "SolutionCache.h"
+#include "solver.h"
+
+template <int BlockCount>
+struct Hint
+{
+    // Number of moves still needed, -1 if no solved board was found
+    // When the explored region was cut off (m_exact is false), -1 only means no solved board is within the region:
+    // the goal may well be reachable through boards beyond it.
+    int m_movesRemaining;
+
+    // Whether m_movesRemaining is the minimum, or -1 because the goal can't be reached at all
+    // Otherwise it is the length of some path to the goal within the explored region, or -1 as above
+    bool m_exact;
+
+    // Move to make next, only meaningful when m_movesRemaining > 0
+    SolutionMove m_move;
+};
+
+// Applies a single move to state, the moved block is identified by its position
+template <int BlockCount>
+BoardState<BlockCount> applyMove(const BoardState<BlockCount> &state, const SolutionMove &step)
+{
+    const auto moveIfAt = [&](const Block &block)
+    {
+        return block.m_startX == step.m_x && block.m_startY == step.m_y ? move(block, step.m_direction) : block;
+    };
+
+    std::array<Block, BlockCount> blocks{};
+    std::transform(begin(state.m_blocks), end(state.m_blocks), begin(blocks), moveIfAt);
+    return BoardState<BlockCount>{ state.m_numberOfMovesFromStart + 1, moveIfAt(state.m_runner), std::move(blocks) };
+}
+
+// Answers "best next move" & "moves remaining" for every board the player reaches, after a single search
+// The first hint explores all boards reachable from the player's board (up to maxStates of them),
+// then a single BFS from all solved boards among them yields the distance to the goal of each one.
+// Later hints are lookups in that distance field. Boards are only explored again once the player
+// leaves the explored region, which can only happen if it had to be cut off at maxStates: the region
+// is then discarded & explored from scratch around the player's new board, rather than extended,
+// so going back to a board of an earlier region explores that one again too.
+template <
+    int BlockCount,
+    typename MoveDiscovery
+>
+class HintEngine
+{
+public:
+    using Index = typename Frontier<BlockCount>::Index;
+
+public:
+    explicit HintEngine(const Puzzle<BlockCount> &puzzle, std::size_t maxStates = 1 << 22)
+        : m_puzzle{ puzzle }
+        , m_hasher{ puzzle }
+        , m_maxStates{ maxStates }
+        , m_states{ puzzle.m_initialState }
+        , m_indices{}
+        , m_distances{}
+        , m_complete{ false }
+        , m_explorations{ 0 }
+    {
+    }
+
+    Hint<BlockCount> hint(const BoardState<BlockCount> &state)
+    {
+        if (m_indices.find(m_hasher.hash(state)) == end(m_indices))
+        {
+            explore(state);
+        }
+
+        const auto distance = m_distances[m_indices.at(m_hasher.hash(state))];
+        Hint<BlockCount> result{ distance, m_complete, SolutionMove{} };
+        if (distance <= 0)
+        {
+            // Already solved, or no way to the goal
+            result.m_exact = result.m_exact || distance == 0;
+            return result;
+        }
+
+        const auto current = std::make_shared<BoardState<BlockCount>>(state);
+        for (auto &move : MoveDiscovery::gatherMoves(m_puzzle.m_dimensions, current, m_puzzle.m_forbiddenSpots))
+        {
+            const auto next = m_indices.find(m_hasher.hash(move()));
+            if (next != end(m_indices) && m_distances[next->second] == distance - 1)
+            {
+                result.m_move = SolutionMove{ move.m_block.m_startX, move.m_block.m_startY, move.m_block.m_sizeX, move.m_directionToMove };
+                break;
+            }
+        }
+        return result;
+    }
+
+    // Number of boards in the explored region
+    std::size_t regionSize() const
+    {
+        return m_states.size();
+    }
+
+    // Number of times boards had to be explored
+    std::size_t explorations() const
+    {
+        return m_explorations;
+    }
+
+private:
+    template <typename Visit>
+    void forEachNeighbour(Index index, Visit visit) const
+    {
+        const auto state = std::make_shared<BoardState<BlockCount>>(m_states.at(index, 0));
+        for (auto &move : MoveDiscovery::gatherMoves(m_puzzle.m_dimensions, state, m_puzzle.m_forbiddenSpots))
+        {
+            const auto neighbour = move();
+            visit(neighbour, m_hasher.hash(neighbour));
+        }
+    }
+
+    void explore(const BoardState<BlockCount> &root)
+    {
+        ++m_explorations;
+        m_states.clear();
+        m_indices.clear();
+        m_complete = true;
+
+        // Every board reachable from root, the archive doubles as BFS queue
+        m_states.push_back(root);
+        m_indices.emplace(m_hasher.hash(root), 0);
+        for (Index next = 0; next < m_states.size() && m_complete; ++next)
+        {
+            forEachNeighbour(next, [&](const BoardState<BlockCount> &neighbour, std::uint64_t hash)
+            {
+                if (m_indices.find(hash) != end(m_indices))
+                {
+                    return;
+                }
+                if (m_states.size() >= m_maxStates)
+                {
+                    m_complete = false;
+                    return;
+                }
+                m_indices.emplace(hash, static_cast<Index>(m_states.size()));
+                m_states.push_back(neighbour);
+            });
+        }
+
+        // Multi-source BFS from every solved board, moves can be undone so distances are symmetric
+        // Note: when the region was cut off, paths leaving it are not considered
+        m_distances.assign(m_states.size(), -1);
+        std::vector<Index> queue;
+        for (Index index = 0; index < m_states.size(); ++index)
+        {
+            if (isSolution(m_states.at(index, 0), m_puzzle.m_goal))
+            {
+                m_distances[index] = 0;
+                queue.push_back(index);
+            }
+        }
+        for (auto next = 0u; next < queue.size(); ++next)
+        {
+            forEachNeighbour(queue[next], [&](const BoardState<BlockCount> &, std::uint64_t hash)
+            {
+                const auto neighbour = m_indices.find(hash);
+                if (neighbour != end(m_indices) && m_distances[neighbour->second] < 0)
+                {
+                    m_distances[neighbour->second] = m_distances[queue[next]] + 1;
+                    queue.push_back(neighbour->second);
+                }
+            });
+        }
+    }
+
+private:
+    const Puzzle<BlockCount> m_puzzle;
+    // Regions can hold millions of boards, 32 bit hashes would collide & short-circuit the distance field
+    BoardHasher<std::uint64_t> m_hasher;
+    const std::size_t m_maxStates;
+
+    // Explored region & the distance to the goal of every board in it
+    Frontier<BlockCount> m_states;
+    std::unordered_map<std::uint64_t, Index> m_indices;
+    std::vector<int> m_distances;
+
+    // Whether every board reachable from the root was explored
+    bool m_complete;
+    std::size_t m_explorations;
+};
+
+template <int BlockCount, typename MoveDiscovery = MoveRunnerFirst<>>
+HintEngine<BlockCount, MoveDiscovery> makeHintEngine(const Puzzle<BlockCount> &puzzle, std::size_t maxStates = 1 << 22)
+{
+    return HintEngine<BlockCount, MoveDiscovery>{ puzzle, maxStates };
+}
@@ -0,0 +1,277 @@
+#include "MemoryBackend.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    std::size_t roundUp(std::size_t bytes, std::size_t multiple)
+    {
+        return (bytes + multiple - 1) / multiple * multiple;
+    }
+
+#if defined(__linux__)
+    // Bytes of [begin, end) backed by transparent huge pages, from the AnonHugePages of the areas overlapping it
+    // Adjacent mappings with the same flags are merged into one area, which is then counted in proportion
+    std::size_t transparentHugePageBytes(std::uintptr_t begin, std::uintptr_t end)
+    {
+        std::ifstream smaps{ "/proc/self/smaps" };
+        std::size_t result = 0;
+        std::uintptr_t areaBegin = 0;
+        std::uintptr_t areaEnd = 0;
+        for (std::string line; std::getline(smaps, line);)
+        {
+            std::istringstream fields{ line };
+            std::string field;
+            fields >> field;
+            const auto dash = field.find('-');
+            if (dash != std::string::npos && field.find(':') == std::string::npos)
+            {
+                areaBegin = static_cast<std::uintptr_t>(std::stoull(field.substr(0, dash), nullptr, 16));
+                areaEnd = static_cast<std::uintptr_t>(std::stoull(field.substr(dash + 1), nullptr, 16));
+            }
+            else if (field == "AnonHugePages:" && areaBegin < end && begin < areaEnd)
+            {
+                std::size_t kilobytes = 0;
+                fields >> kilobytes;
+                const auto overlap = std::min(end, areaEnd) - std::max(begin, areaBegin);
+                result += static_cast<std::size_t>(static_cast<double>(kilobytes) * 1024 * overlap / (areaEnd - areaBegin));
+            }
+        }
+        return result;
+    }
+#endif
+
+    // Moves the calling thread to cpu, or leaves it where it is if that isn't possible
+    void runOn(int cpu)
+    {
+#if defined(__linux__)
+        if (cpu >= 0 && cpu < CPU_SETSIZE)
+        {
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            CPU_SET(cpu, &cpus);
+            ::pthread_setaffinity_np(::pthread_self(), sizeof(cpus), &cpus);
+        }
+#else
+        (void)cpu;
+#endif
+    }
+}
+
+MemoryBackend::MemoryBackend(MemoryOptions options)
+    : m_options{ options }
+    , m_mutex{}
+    , m_mappings{}
+    , m_unmappedBytes{ 0 }
+{
+}
+
+MemoryBackend::~MemoryBackend() = default;
+
+void *MemoryBackend::allocate(std::size_t bytes)
+{
+    if (bytes >= m_options.m_mappingThreshold)
+    {
+        Mapping mapping{ bytes, 0, HugePages::None };
+        if (const auto memory = map(bytes, mapping))
+        {
+            std::lock_guard<std::mutex> lock{ m_mutex };
+            m_mappings.emplace(memory, mapping);
+            return memory;
+        }
+    }
+
+    const auto memory = ::operator new(bytes);
+    std::lock_guard<std::mutex> lock{ m_mutex };
+    m_unmappedBytes += bytes;
+    return memory;
+}
+
+void MemoryBackend::deallocate(void *memory, std::size_t bytes)
+{
+    {
+        std::lock_guard<std::mutex> lock{ m_mutex };
+        const auto mapping = m_mappings.find(memory);
+        if (mapping == end(m_mappings))
+        {
+            m_unmappedBytes -= bytes;
+        }
+        else
+        {
+            const auto mappedBytes = mapping->second.m_mappedBytes;
+            m_mappings.erase(mapping);
+#if defined(__linux__)
+            ::munmap(memory, mappedBytes);
+#endif
+            return;
+        }
+    }
+    ::operator delete(memory);
+}
+
+MemoryStats MemoryBackend::stats() const
+{
+    std::lock_guard<std::mutex> lock{ m_mutex };
+    MemoryStats result{ m_unmappedBytes, 0, 0, basePageSize() };
+    for (const auto &entry : m_mappings)
+    {
+        const auto &mapping = entry.second;
+        result.m_bytes += mapping.m_bytes;
+        result.m_mappedBytes += mapping.m_bytes;
+
+        auto hugeBytes = std::size_t{ 0 };
+        if (mapping.m_hugePages == HugePages::Explicit)
+        {
+            hugeBytes = mapping.m_bytes;
+        }
+#if defined(__linux__)
+        else if (mapping.m_hugePages == HugePages::Transparent)
+        {
+            const auto begin = reinterpret_cast<std::uintptr_t>(entry.first);
+            hugeBytes = std::min(mapping.m_bytes, transparentHugePageBytes(begin, begin + mapping.m_mappedBytes));
+        }
+#endif
+        result.m_hugePageBytes += hugeBytes;
+        result.m_pageSize = std::max(result.m_pageSize, hugeBytes > 0 ? hugePageSize() : basePageSize());
+    }
+    return result;
+}
+
+std::size_t MemoryBackend::basePageSize()
+{
+#if defined(__linux__)
+    return static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+#else
+    return 4096;
+#endif
+}
+
+std::size_t MemoryBackend::hugePageSize()
+{
+    static const auto size = []()
+    {
+        // "Hugepagesize:    2048 kB"
+        std::ifstream meminfo{ "/proc/meminfo" };
+        for (std::string name; meminfo >> name;)
+        {
+            std::size_t kilobytes = 0;
+            if (name == "Hugepagesize:" && meminfo >> kilobytes)
+            {
+                return kilobytes * 1024;
+            }
+            meminfo.ignore(256, '\n');
+        }
+        return std::size_t{ 2 } << 20;
+    }();
+    return size;
+}
+
+// Tries explicit huge pages first (if asked for), then a base page mapping, advised to use transparent huge pages
+// Returns nullptr if nothing could be mapped
+void *MemoryBackend::map(std::size_t bytes, Mapping &mapping)
+{
+#if defined(__linux__)
+    if (m_options.m_hugePages == HugePages::Explicit)
+    {
+        const auto mappedBytes = roundUp(bytes, hugePageSize());
+        const auto memory = ::mmap(nullptr, mappedBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (memory != MAP_FAILED)
+        {
+            mapping.m_mappedBytes = mappedBytes;
+            mapping.m_hugePages = HugePages::Explicit;
+            prefault(static_cast<char *>(memory), mappedBytes, hugePageSize());
+            return memory;
+        }
+    }
+
+    // Transparent huge pages are only used for huge page aligned ranges, so the mapping is made one huge page
+    // larger than needed & trimmed to an aligned start
+    const auto transparent = m_options.m_hugePages != HugePages::None;
+    const auto alignment = transparent ? hugePageSize() : basePageSize();
+    const auto mappedBytes = roundUp(bytes, alignment);
+    const auto reserved = mappedBytes + (transparent ? alignment : 0);
+    const auto memory = ::mmap(nullptr, reserved, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED)
+    {
+        return nullptr;
+    }
+
+    const auto start = reinterpret_cast<std::uintptr_t>(memory);
+    const auto aligned = roundUp(start, alignment);
+    if (aligned > start)
+    {
+        ::munmap(memory, aligned - start);
+    }
+    if (start + reserved > aligned + mappedBytes)
+    {
+        ::munmap(reinterpret_cast<void *>(aligned + mappedBytes), start + reserved - (aligned + mappedBytes));
+    }
+
+    mapping.m_mappedBytes = mappedBytes;
+    if (transparent && ::madvise(reinterpret_cast<void *>(aligned), mappedBytes, MADV_HUGEPAGE) == 0)
+    {
+        mapping.m_hugePages = HugePages::Transparent;
+    }
+    prefault(reinterpret_cast<char *>(aligned), mappedBytes, mapping.m_hugePages == HugePages::None ? basePageSize() : hugePageSize());
+    return reinterpret_cast<void *>(aligned);
+#else
+    (void)bytes;
+    (void)mapping;
+    return nullptr;
+#endif
+}
+
+// Writes a zero to every page, anonymous mappings are zero filled so the contents don't change
+// Threads are only pinned to CPUs when asked to, on threads of their own so the caller's affinity doesn't change
+void MemoryBackend::prefault(char *memory, std::size_t bytes, std::size_t pageSize) const
+{
+    if (!m_options.m_prefault)
+    {
+        return;
+    }
+
+    const auto &cpus = m_options.m_firstTouchCpus;
+    const auto pages = bytes / pageSize;
+    const auto threads = std::max(1u, std::min(m_options.m_firstTouchThreads, static_cast<unsigned>(std::max<std::size_t>(1, pages))));
+    const auto pagesPerThread = (pages + threads - 1) / threads;
+    const auto touch = [&](unsigned thread)
+    {
+        if (!cpus.empty())
+        {
+            runOn(cpus[thread % cpus.size()]);
+        }
+
+        const auto last = std::min(pages, (thread + 1) * pagesPerThread);
+        for (auto page = thread * pagesPerThread; page < last; ++page)
+        {
+            static_cast<volatile char *>(memory)[page * pageSize] = 0;
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (auto thread = cpus.empty() ? 1u : 0u; thread < threads; ++thread)
+    {
+        workers.emplace_back(touch, thread);
+    }
+    if (cpus.empty())
+    {
+        touch(0);
+    }
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+}
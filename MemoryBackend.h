@@ -0,0 +1,160 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+enum class HugePages
+{
+    // Base pages only
+    None,
+
+    // Ask the kernel to back the mapping with huge pages where it can (madvise)
+    Transparent,
+
+    // Pages from the reserved huge page pool (MAP_HUGETLB), falling back to Transparent when the pool is empty
+    Explicit,
+};
+
+struct MemoryOptions
+{
+    // Allocations of at least this many bytes get their own anonymous mapping, smaller ones come from operator new
+    std::size_t m_mappingThreshold = std::size_t{ 1 } << 21;
+
+    HugePages m_hugePages = HugePages::Transparent;
+
+    // Touch every page of a mapping when it is made, so page faults don't happen in the middle of the search
+    bool m_prefault = false;
+
+    // Threads pre-faulting a mapping, each touching its own consecutive share of the pages
+    // With first-touch NUMA placement, every share then lives on the node of the thread which touched it:
+    // use the number of threads which will work on consecutive partitions of the array
+    unsigned m_firstTouchThreads = 1;
+
+    // CPUs the pre-faulting threads run on, thread i on m_firstTouchCpus[i % size], e.g. one CPU of each NUMA node
+    // Empty leaves them to the scheduler, which may well run every share on the same node.
+    // Note: only supported on Linux, CPUs the process can't run on are left to the scheduler too
+    std::vector<int> m_firstTouchCpus;
+};
+
+struct MemoryStats
+{
+    // Bytes of all live allocations
+    std::size_t m_bytes;
+
+    // Bytes of them in anonymous mappings
+    std::size_t m_mappedBytes;
+
+    // Bytes of them backed by huge pages, explicit or transparent
+    std::size_t m_hugePageBytes;
+
+    // Largest page size backing any of them
+    std::size_t m_pageSize;
+};
+
+// Source of the memory of the large arrays of a search (visited set, frontier)
+// Large allocations are anonymous mappings, optionally huge page backed & pre-faulted, so walking a
+// multi-GB table doesn't miss the TLB on every access. When mapping fails, or isn't supported on the platform,
+// memory comes from operator new instead.
+// Thread safe, allocators of several containers share one backend to report their memory together.
+class MemoryBackend
+{
+public:
+    explicit MemoryBackend(MemoryOptions options = MemoryOptions{});
+    ~MemoryBackend();
+
+    MemoryBackend(const MemoryBackend &) = delete;
+    MemoryBackend &operator=(const MemoryBackend &) = delete;
+
+    void *allocate(std::size_t bytes);
+    void deallocate(void *memory, std::size_t bytes);
+
+    // Note: transparent huge pages are counted as reported by the kernel, which may promote pages later on
+    MemoryStats stats() const;
+
+    const MemoryOptions &options() const { return m_options; }
+
+    // Size of base pages & of huge pages on this system
+    static std::size_t basePageSize();
+    static std::size_t hugePageSize();
+
+private:
+    struct Mapping
+    {
+        // Bytes requested & bytes mapped, rounded up to the page size
+        std::size_t m_bytes;
+        std::size_t m_mappedBytes;
+        HugePages m_hugePages;
+    };
+
+    void *map(std::size_t bytes, Mapping &mapping);
+    void prefault(char *memory, std::size_t bytes, std::size_t pageSize) const;
+
+private:
+    const MemoryOptions m_options;
+    mutable std::mutex m_mutex;
+    std::unordered_map<void *, Mapping> m_mappings;
+    std::size_t m_unmappedBytes;
+};
+
+// Standard allocator on a shared MemoryBackend, plain operator new & delete without one
+// Containers swap & move their backend along with their elements.
+template <typename T>
+class BackendAllocator
+{
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+public:
+    BackendAllocator(std::shared_ptr<MemoryBackend> backend = nullptr)
+        : m_backend{ std::move(backend) }
+    {
+    }
+
+    template <typename U>
+    BackendAllocator(const BackendAllocator<U> &other)
+        : m_backend{ other.backend() }
+    {
+    }
+
+    T *allocate(std::size_t count)
+    {
+        const auto bytes = count * sizeof(T);
+        return static_cast<T *>(m_backend ? m_backend->allocate(bytes) : ::operator new(bytes));
+    }
+
+    void deallocate(T *memory, std::size_t count)
+    {
+        if (m_backend)
+        {
+            m_backend->deallocate(memory, count * sizeof(T));
+        }
+        else
+        {
+            ::operator delete(memory);
+        }
+    }
+
+    const std::shared_ptr<MemoryBackend> &backend() const { return m_backend; }
+
+private:
+    std::shared_ptr<MemoryBackend> m_backend;
+};
+
+template <typename T, typename U>
+bool operator==(const BackendAllocator<T> &left, const BackendAllocator<U> &right)
+{
+    return left.backend() == right.backend();
+}
+
+template <typename T, typename U>
+bool operator!=(const BackendAllocator<T> &left, const BackendAllocator<U> &right)
+{
+    return !(left == right);
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "block.h"
+#include "MoveDiscovery.h"
+#include "puzzle.h"
+
+// Last move on the path to a board, all the history the pruning rules need
+struct MoveHistory
+{
+    constexpr static int noPiece = -1;
+
+    // Piece moved: 0 for the runner, i + 1 for BoardState::m_blocks[i], noPiece before the first move
+    int m_piece = noPiece;
+
+    Direction m_direction = Direction::Number_of_dirs;
+
+    // Cells covered by the piece before or after the move
+    Block m_touched{ 0, 0, 0, 0, {} };
+};
+
+template <int BlockCount>
+struct PrunedMove
+{
+    Move<BlockCount> m_move;
+
+    // History to pass on when gathering the moves of the board after m_move
+    MoveHistory m_history;
+};
+
+enum class PruningRules
+{
+    // Every move of the MoveDiscovery policy
+    None,
+
+    // No move undoing the previous one
+    Reversals,
+
+    // No reversals & of two consecutive moves of pieces which don't interact, only the one in piece order
+    ReversalsAndCommutations,
+};
+
+// Drops moves which can't be part of a shortest path, or for which an equivalent path is generated anyway,
+// for depth-first searches which don't remember the boards they've seen
+// - reversals: moving a piece back where it came from returns to the previous board
+// - commutations: when two consecutive moves touch disjoint cells, either order is legal & leads to the same board,
+//   so only the order with the lowest piece first is kept
+// Any shortest solution can be reordered into one these rules keep, by swapping consecutive commuting moves
+// until they are in piece order, so the length of the shortest solution found doesn't change.
+// Note: only valid when every single-cell slide counts as a move (MoveMetric::Steps)
+template <
+    PruningRules Rules = PruningRules::ReversalsAndCommutations,
+    typename MoveDiscovery = MoveRunnerFirst<>
+>
+struct MovePruning
+{
+    template <int BlockCount>
+    static std::vector<PrunedMove<BlockCount>> gatherMoves(
+        const Point dimensions,
+        const std::shared_ptr<BoardState<BlockCount>> &currentState,
+        const std::vector<Point> &invalidPositions,
+        const MoveHistory &previous = MoveHistory{})
+    {
+        std::vector<PrunedMove<BlockCount>> newMoves{};
+        for (const auto &move : MoveDiscovery::gatherMoves(dimensions, currentState, invalidPositions))
+        {
+            const auto piece = pieceOf(*currentState, move.m_block);
+            const auto direction = move.m_directionToMove;
+            const auto touched = touchedBy(move.m_block, direction);
+            if (Rules != PruningRules::None && previous.m_piece != MoveHistory::noPiece)
+            {
+                if (piece == previous.m_piece && direction == reverse(previous.m_direction))
+                {
+                    continue;
+                }
+                if (Rules == PruningRules::ReversalsAndCommutations && piece < previous.m_piece && !overlaps(touched, previous.m_touched))
+                {
+                    continue;
+                }
+            }
+            newMoves.push_back(PrunedMove<BlockCount>{ move, MoveHistory{ piece, direction, touched } });
+        }
+        return newMoves;
+    }
+
+    static Direction reverse(Direction direction)
+    {
+        switch (direction)
+        {
+        case Up:
+            return Down;
+        case Down:
+            return Up;
+        case Left:
+            return Right;
+        case Right:
+            return Left;
+        default:
+            return Number_of_dirs;
+        }
+    }
+
+    // Smallest block covering block before & after moving it in direction
+    static Block touchedBy(const Block &block, Direction direction)
+    {
+        const auto moved = move(block, direction);
+        return Block{
+            std::min(block.m_startX, moved.m_startX),
+            std::min(block.m_startY, moved.m_startY),
+            block.m_sizeX + (block.m_startX != moved.m_startX ? 1 : 0),
+            block.m_sizeY + (block.m_startY != moved.m_startY ? 1 : 0),
+            block.id };
+    }
+
+    // Moves refer to the blocks of the state they were gathered from
+    template <int BlockCount>
+    static int pieceOf(const BoardState<BlockCount> &state, const Block &block)
+    {
+        if (&block == &state.m_runner)
+        {
+            return 0;
+        }
+        return static_cast<int>(&block - state.m_blocks.data()) + 1;
+    }
+};
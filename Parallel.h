@@ -0,0 +1,23 @@
+#pragma once
+
+#include <thread>
+#include <vector>
+
+namespace detail
+{
+    // Runs work(worker) for every worker, the calling thread being worker 0
+    template <typename Work>
+    void forEachWorker(unsigned workers, const Work &work)
+    {
+        std::vector<std::thread> threads;
+        for (auto worker = 1u; worker < workers; ++worker)
+        {
+            threads.emplace_back(work, worker);
+        }
+        work(0u);
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+    }
+}
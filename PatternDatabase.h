@@ -0,0 +1,322 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Fingerprint.h"
+#include "puzzle.h"
+#include "Serialization.h"
+
+// Exact distances to the goal of an abstraction of a puzzle: the runner & a subset of the blocks,
+// with all other blocks removed from the board. Removing blocks only makes a board easier,
+// so the abstract distance of a board is a lower bound on its real distance.
+// Every placement of the kept pieces is ranked as a number in base (width * height), one digit per piece,
+// & its distance stored in a byte array indexed by that rank. Distances are found by a retrograde BFS
+// from all placements with the runner at the goal. Placements which can't reach the goal are marked unreachable.
+// When runner moves are not counted, only moves of the blocks in the pattern add to the distance,
+// so the distances of patterns with disjoint blocks can be added up (see PatternDatabaseHeuristic).
+// Note: the goal & board layout are part of the database, it only answers for puzzles of the same board family
+template <int BlockCount>
+class PatternDatabase
+{
+public:
+    // Returned for boards from which the goal can't be reached
+    constexpr static int unreachable = 1 << 20;
+
+public:
+    // blocks are indices into BoardState::m_blocks
+    // If cacheDirectory is given, the database is read from it when it was built before for the same
+    // board family & pattern, otherwise it is built & written to it
+    PatternDatabase(const Puzzle<BlockCount> &puzzle, std::vector<int> blocks, bool countsRunnerMoves = true, std::string cacheDirectory = {})
+        : m_width{ puzzle.m_dimensions.m_x }
+        , m_height{ puzzle.m_dimensions.m_y }
+        , m_blocks{ std::move(blocks) }
+        , m_countsRunnerMoves{ countsRunnerMoves }
+        , m_footprints{}
+        , m_distances{}
+        , m_description{}
+        , m_loaded{ false }
+    {
+        const auto cells = m_width * m_height;
+        if (cells > 64)
+        {
+            throw std::runtime_error("Board too large for a pattern database");
+        }
+
+        std::vector<Block> pieces{ puzzle.m_initialState.m_runner };
+        for (const auto block : m_blocks)
+        {
+            pieces.push_back(puzzle.m_initialState.m_blocks.at(static_cast<std::size_t>(block)));
+        }
+
+        auto entries = std::size_t{ 1 };
+        for (auto i = 0u; i < pieces.size(); ++i)
+        {
+            entries *= static_cast<std::size_t>(cells);
+            if (entries > maxEntries)
+            {
+                throw std::runtime_error("Too many pieces in pattern");
+            }
+        }
+
+        // Cells covered by each piece at each cell, 0 if it doesn't fit there
+        for (const auto &piece : pieces)
+        {
+            std::vector<std::uint64_t> footprints(static_cast<std::size_t>(cells), 0);
+            for (auto x = 0; x < m_width; ++x)
+            {
+                for (auto y = 0; y < m_height; ++y)
+                {
+                    footprints[cell(x, y)] = footprint(Block{ x, y, piece.m_sizeX, piece.m_sizeY, piece.id }, puzzle);
+                }
+            }
+            m_footprints.push_back(std::move(footprints));
+        }
+
+        m_description = { m_width, m_height, puzzle.m_goal.m_startX, puzzle.m_goal.m_startY, m_countsRunnerMoves ? 1 : 0 };
+        for (const auto &spot : puzzle.m_forbiddenSpots)
+        {
+            m_description.insert(end(m_description), { spot.m_x, spot.m_y });
+        }
+        for (const auto &piece : pieces)
+        {
+            m_description.insert(end(m_description), { piece.m_sizeX, piece.m_sizeY });
+        }
+
+        if (!cacheDirectory.empty() && readFromDisk(cacheDirectory))
+        {
+            m_loaded = true;
+            return;
+        }
+        build(puzzle.m_goal, entries);
+        if (!cacheDirectory.empty())
+        {
+            writeToDisk(cacheDirectory);
+        }
+    }
+
+    // Lower bound on the number of moves from state to the goal, unreachable if there is no way to the goal
+    int operator()(const BoardState<BlockCount> &state) const
+    {
+        auto rank = static_cast<std::size_t>(cell(state.m_runner.m_startX, state.m_runner.m_startY));
+        auto radix = static_cast<std::size_t>(cellCount());
+        for (const auto block : m_blocks)
+        {
+            const auto &piece = state.m_blocks[static_cast<std::size_t>(block)];
+            rank += radix * static_cast<std::size_t>(cell(piece.m_startX, piece.m_startY));
+            radix *= static_cast<std::size_t>(cellCount());
+        }
+
+        const auto distance = m_distances[rank];
+        return distance == unreachableDistance ? unreachable : distance;
+    }
+
+    const std::vector<int> &blocks() const { return m_blocks; }
+    bool countsRunnerMoves() const { return m_countsRunnerMoves; }
+    std::size_t size() const { return m_distances.size(); }
+
+    // Whether the database was read from the cache directory rather than built
+    bool loadedFromDisk() const { return m_loaded; }
+
+    // File the database is cached in, within directory
+    std::string cachePathOf(const std::string &directory) const
+    {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.pdb", static_cast<unsigned long long>(detail::fnv1a(m_description)));
+        return directory + "/" + name;
+    }
+
+private:
+    constexpr static std::uint8_t unreachableDistance = 0xff;
+    constexpr static std::size_t maxEntries = std::size_t{ 1 } << 28;
+    constexpr static std::uint32_t databaseMagic = 0x4244'504b; // "KPDB"
+
+    int cellCount() const { return m_width * m_height; }
+    std::size_t cell(int x, int y) const { return static_cast<std::size_t>(x * m_height + y); }
+
+    static std::uint64_t footprint(const Block &block, const Puzzle<BlockCount> &puzzle)
+    {
+        if (block.m_startX + block.m_sizeX > puzzle.m_dimensions.m_x || block.m_startY + block.m_sizeY > puzzle.m_dimensions.m_y)
+        {
+            return 0;
+        }
+
+        std::uint64_t covered = 0;
+        for (auto x = block.m_startX; x < block.m_startX + block.m_sizeX; ++x)
+        {
+            for (auto y = block.m_startY; y < block.m_startY + block.m_sizeY; ++y)
+            {
+                const auto forbidden = std::any_of(begin(puzzle.m_forbiddenSpots), end(puzzle.m_forbiddenSpots), [&](const Point &spot)
+                {
+                    return spot.m_x == x && spot.m_y == y;
+                });
+                if (forbidden)
+                {
+                    return 0;
+                }
+                covered |= std::uint64_t{ 1 } << (x * puzzle.m_dimensions.m_y + y);
+            }
+        }
+        return covered;
+    }
+
+    // Cell of every piece of the placement with rank, returns false if the pieces don't fit together
+    bool unrank(std::size_t rank, std::vector<std::size_t> &cells, std::vector<std::uint64_t> &covered) const
+    {
+        std::uint64_t occupied = 0;
+        for (auto piece = 0u; piece < m_footprints.size(); ++piece)
+        {
+            cells[piece] = rank % static_cast<std::size_t>(cellCount());
+            rank /= static_cast<std::size_t>(cellCount());
+            covered[piece] = m_footprints[piece][cells[piece]];
+            if (covered[piece] == 0 || (covered[piece] & occupied) != 0)
+            {
+                return false;
+            }
+            occupied |= covered[piece];
+        }
+        return true;
+    }
+
+    // 0-1 BFS backwards from every placement with the runner at the goal
+    // Moves can be undone, so the distance to the goal equals the distance from the goal
+    void build(const Block &goal, std::size_t entries)
+    {
+        m_distances.assign(entries, std::uint8_t{ unreachableDistance });
+        std::vector<std::size_t> cells(m_footprints.size());
+        std::vector<std::uint64_t> covered(m_footprints.size());
+
+        std::deque<std::size_t> queue;
+        for (auto rank = 0u; rank < entries; ++rank)
+        {
+            if (unrank(rank, cells, covered) && cells[0] == cell(goal.m_startX, goal.m_startY))
+            {
+                m_distances[rank] = 0;
+                queue.push_back(rank);
+            }
+        }
+
+        constexpr int steps[4][2] = { { 0, -1 }, { 0, 1 }, { -1, 0 }, { 1, 0 } };
+        while (!queue.empty())
+        {
+            const auto rank = queue.front();
+            queue.pop_front();
+            unrank(rank, cells, covered);
+
+            auto occupied = std::uint64_t{ 0 };
+            for (const auto piece : covered)
+            {
+                occupied |= piece;
+            }
+
+            auto radix = std::size_t{ 1 };
+            for (auto piece = 0u; piece < cells.size(); ++piece, radix *= static_cast<std::size_t>(cellCount()))
+            {
+                const auto cost = piece == 0 && !m_countsRunnerMoves ? 0 : 1;
+                const auto distance = std::min(m_distances[rank] + cost, unreachableDistance - 1);
+                const auto x = static_cast<int>(cells[piece]) / m_height;
+                const auto y = static_cast<int>(cells[piece]) % m_height;
+                for (const auto &step : steps)
+                {
+                    const auto nextX = x + step[0];
+                    const auto nextY = y + step[1];
+                    if (nextX < 0 || nextX >= m_width || nextY < 0 || nextY >= m_height)
+                    {
+                        continue;
+                    }
+
+                    const auto nextCell = cell(nextX, nextY);
+                    const auto nextCovered = m_footprints[piece][nextCell];
+                    if (nextCovered == 0 || (nextCovered & (occupied & ~covered[piece])) != 0)
+                    {
+                        continue;
+                    }
+
+                    const auto next = rank - radix * cells[piece] + radix * nextCell;
+                    if (distance < m_distances[next])
+                    {
+                        m_distances[next] = static_cast<std::uint8_t>(distance);
+                        if (cost == 0)
+                        {
+                            queue.push_front(next);
+                        }
+                        else
+                        {
+                            queue.push_back(next);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    bool readFromDisk(const std::string &directory)
+    {
+        std::ifstream in{ cachePathOf(directory), std::ios::binary };
+        if (!in)
+        {
+            return false;
+        }
+
+        try
+        {
+            std::vector<int> description;
+            serialization::expect(in, databaseMagic, "not a pattern database");
+            serialization::readVector(in, description);
+            if (description != m_description)
+            {
+                // Another pattern with the same hash
+                return false;
+            }
+            serialization::readVector(in, m_distances);
+            return true;
+        }
+        catch (const std::runtime_error &)
+        {
+            // Truncated or corrupt file, build again
+            return false;
+        }
+    }
+
+    // Written to a temporary file first, so readers never see a partially written database
+    void writeToDisk(const std::string &directory) const
+    {
+        const auto path = cachePathOf(directory);
+        const auto temporaryPath = path + ".tmp";
+        {
+            std::ofstream out{ temporaryPath, std::ios::binary | std::ios::trunc };
+            serialization::write(out, databaseMagic);
+            serialization::writeVector(out, m_description);
+            serialization::writeVector(out, m_distances);
+            if (!out)
+            {
+                return;
+            }
+        }
+        std::rename(temporaryPath.c_str(), path.c_str());
+    }
+
+private:
+    int m_width;
+    int m_height;
+
+    // Blocks kept besides the runner, which is always part of the pattern
+    std::vector<int> m_blocks;
+    bool m_countsRunnerMoves;
+
+    // Per piece of the pattern (runner first), per cell: the cells it covers when placed there
+    std::vector<std::vector<std::uint64_t>> m_footprints;
+
+    // Distance to the goal by rank of the placement
+    std::vector<std::uint8_t> m_distances;
+
+    // Board family & pattern the distances are valid for
+    std::vector<int> m_description;
+    bool m_loaded;
+};
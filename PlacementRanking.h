@@ -0,0 +1,291 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <vector>
+
+#include "puzzle.h"
+
+// Perfect ranking of every legal layout of a puzzle's pieces: layouts map one to one onto [0, size())
+// Blocks of the same size are interchangeable, layouts only differing by swapping them share a rank.
+// The 1x1 blocks fit on any free cell, so layouts are split in two:
+// - the skeleton: runner & all larger blocks, numbered by their index in a sorted table of all skeletons
+// - the cells of the 1x1 blocks among the cells the skeleton leaves free, numbered as a combination
+// Every skeleton leaves the same number of free cells, so rank = skeleton * combinations + combination.
+// Only the skeletons are stored, e.g. 13120 of them for the 918400 layouts of the standard klotski board.
+template <int BlockCount>
+class PlacementRanking
+{
+public:
+    constexpr static int pieceCount = BlockCount + 1;
+
+public:
+    explicit PlacementRanking(const Puzzle<BlockCount> &family)
+        : m_pieces{}
+        , m_width{ family.m_dimensions.m_x }
+        , m_height{ family.m_dimensions.m_y }
+        , m_forbidden{ 0 }
+        , m_skeletonPieces{}
+        , m_fillerPieces{}
+        , m_skeletons{}
+        , m_combinations{ 1 }
+        , m_binomials{}
+    {
+        if (m_width * m_height > 64)
+        {
+            throw std::runtime_error("Board too large to rank");
+        }
+
+        m_pieces[0] = family.m_initialState.m_runner;
+        for (auto i = 0; i < BlockCount; ++i)
+        {
+            m_pieces[i + 1] = family.m_initialState.m_blocks[i];
+        }
+        for (const auto &spot : family.m_forbiddenSpots)
+        {
+            m_forbidden |= bit(cell(spot.m_x, spot.m_y));
+        }
+
+        auto freeCells = m_width * m_height - static_cast<int>(family.m_forbiddenSpots.size());
+        for (auto piece = 0; piece < pieceCount; ++piece)
+        {
+            const auto filler = piece > 0 && m_pieces[piece].m_sizeX == 1 && m_pieces[piece].m_sizeY == 1;
+            (filler ? m_fillerPieces : m_skeletonPieces).push_back(piece);
+            freeCells -= filler ? 0 : m_pieces[piece].m_sizeX * m_pieces[piece].m_sizeY;
+        }
+        if (m_skeletonPieces.size() * bitsPerCell > 64)
+        {
+            throw std::runtime_error("Too many pieces to rank");
+        }
+
+        for (auto n = 0u; n < m_binomials.size(); ++n)
+        {
+            m_binomials[n][0] = 1;
+            for (auto k = 1u; k < m_binomials[n].size(); ++k)
+            {
+                m_binomials[n][k] = n == 0 ? 0 : m_binomials[n - 1][k - 1] + m_binomials[n - 1][k];
+            }
+        }
+        m_combinations = freeCells >= 0 ? m_binomials[static_cast<std::size_t>(freeCells)][m_fillerPieces.size()] : 0;
+
+        enumerateSkeletons();
+    }
+
+    // Number of legal layouts
+    std::uint64_t size() const
+    {
+        return static_cast<std::uint64_t>(m_skeletons.size()) * m_combinations;
+    }
+
+    std::uint64_t rank(const BoardState<BlockCount> &state) const
+    {
+        std::array<int, pieceCount> cells{};
+        cells[0] = cell(state.m_runner.m_startX, state.m_runner.m_startY);
+        for (auto i = 0; i < BlockCount; ++i)
+        {
+            cells[i + 1] = cell(state.m_blocks[i].m_startX, state.m_blocks[i].m_startY);
+        }
+
+        // Interchangeable blocks are put in order of their cells, as when enumerating the skeletons
+        canonicalize(m_skeletonPieces, cells);
+        std::uint64_t key = 0;
+        auto occupied = m_forbidden;
+        for (const auto piece : m_skeletonPieces)
+        {
+            key = (key << bitsPerCell) | static_cast<std::uint64_t>(cells[piece]);
+            occupied |= covered(piece, cells[piece]);
+        }
+        const auto skeleton = static_cast<std::uint64_t>(std::lower_bound(begin(m_skeletons), end(m_skeletons), key) - begin(m_skeletons));
+
+        // Combination of the filler cells, counted in free cells
+        std::vector<int> freeIndices;
+        for (const auto piece : m_fillerPieces)
+        {
+            freeIndices.push_back(freeIndex(occupied, cells[piece]));
+        }
+        std::sort(begin(freeIndices), end(freeIndices));
+        std::uint64_t combination = 0;
+        for (auto i = 0u; i < freeIndices.size(); ++i)
+        {
+            combination += m_binomials[static_cast<std::size_t>(freeIndices[i])][i + 1];
+        }
+
+        return skeleton * m_combinations + combination;
+    }
+
+    BoardState<BlockCount> unrank(std::uint64_t rank, int movesFromStart) const
+    {
+        std::array<int, pieceCount> cells{};
+        auto key = m_skeletons[static_cast<std::size_t>(rank / m_combinations)];
+        auto occupied = m_forbidden;
+        for (auto i = m_skeletonPieces.size(); i-- > 0;)
+        {
+            const auto piece = m_skeletonPieces[i];
+            cells[piece] = static_cast<int>(key & ((1u << bitsPerCell) - 1));
+            key >>= bitsPerCell;
+            occupied |= covered(piece, cells[piece]);
+        }
+
+        // Largest free index first: the largest n with C(n, k) <= combination
+        auto combination = rank % m_combinations;
+        auto n = static_cast<int>(m_binomials.size()) - 1;
+        for (auto i = m_fillerPieces.size(); i-- > 0;)
+        {
+            while (m_binomials[static_cast<std::size_t>(n)][i + 1] > combination)
+            {
+                --n;
+            }
+            combination -= m_binomials[static_cast<std::size_t>(n)][i + 1];
+            cells[m_fillerPieces[i]] = freeCell(occupied, n);
+        }
+
+        std::array<Block, BlockCount> blocks{};
+        for (auto i = 0; i < BlockCount; ++i)
+        {
+            blocks[i] = placed(i + 1, cells[i + 1]);
+        }
+        return BoardState<BlockCount>{ movesFromStart, placed(0, cells[0]), std::move(blocks) };
+    }
+
+private:
+    constexpr static int bitsPerCell = 6;
+
+    int cell(int x, int y) const { return x * m_height + y; }
+    static std::uint64_t bit(int cell) { return std::uint64_t{ 1 } << cell; }
+
+    Block placed(int piece, int cell) const
+    {
+        const auto &block = m_pieces[piece];
+        return Block{ cell / m_height, cell % m_height, block.m_sizeX, block.m_sizeY, block.id };
+    }
+
+    // Cells covered by piece at cell, 0 if it sticks out of the board
+    std::uint64_t covered(int piece, int cell) const
+    {
+        const auto &block = m_pieces[piece];
+        const auto x = cell / m_height;
+        const auto y = cell % m_height;
+        if (x + block.m_sizeX > m_width || y + block.m_sizeY > m_height)
+        {
+            return 0;
+        }
+
+        std::uint64_t result = 0;
+        for (auto dx = 0; dx < block.m_sizeX; ++dx)
+        {
+            for (auto dy = 0; dy < block.m_sizeY; ++dy)
+            {
+                result |= bit(this->cell(x + dx, y + dy));
+            }
+        }
+        return result;
+    }
+
+    bool sameSize(int left, int right) const
+    {
+        return m_pieces[left].m_sizeX == m_pieces[right].m_sizeX && m_pieces[left].m_sizeY == m_pieces[right].m_sizeY;
+    }
+
+    // Sorts the cells of every group of interchangeable pieces, keeping the groups in place
+    void canonicalize(const std::vector<int> &pieces, std::array<int, pieceCount> &cells) const
+    {
+        for (auto i = 0u; i < pieces.size(); ++i)
+        {
+            for (auto j = i + 1; j < pieces.size(); ++j)
+            {
+                if (pieces[i] > 0 && sameSize(pieces[i], pieces[j]) && cells[pieces[j]] < cells[pieces[i]])
+                {
+                    std::swap(cells[pieces[i]], cells[pieces[j]]);
+                }
+            }
+        }
+    }
+
+    // Number of free cells before cell
+    static int freeIndex(std::uint64_t occupied, int cell)
+    {
+        auto index = 0;
+        for (auto before = 0; before < cell; ++before)
+        {
+            index += (occupied & bit(before)) == 0 ? 1 : 0;
+        }
+        return index;
+    }
+
+    int freeCell(std::uint64_t occupied, int index) const
+    {
+        for (auto cell = 0; ; ++cell)
+        {
+            if ((occupied & bit(cell)) == 0 && index-- == 0)
+            {
+                return cell;
+            }
+        }
+    }
+
+    // Places every skeleton piece on every free cell by backtracking, in increasing key order
+    // Each interchangeable piece is only placed after the previous one of its size
+    void enumerateSkeletons()
+    {
+        std::vector<int> previousOfSize(m_skeletonPieces.size(), -1);
+        for (auto i = 1u; i < m_skeletonPieces.size(); ++i)
+        {
+            for (auto j = i; j-- > 1;)
+            {
+                if (sameSize(m_skeletonPieces[i], m_skeletonPieces[j]))
+                {
+                    previousOfSize[i] = static_cast<int>(j);
+                    break;
+                }
+            }
+        }
+
+        std::vector<int> cells(m_skeletonPieces.size(), 0);
+        std::function<void(std::size_t, std::uint64_t, std::uint64_t)> place = [&](std::size_t i, std::uint64_t occupied, std::uint64_t key)
+        {
+            if (i == m_skeletonPieces.size())
+            {
+                m_skeletons.push_back(key);
+                return;
+            }
+
+            const auto firstCell = previousOfSize[i] < 0 ? 0 : cells[static_cast<std::size_t>(previousOfSize[i])] + 1;
+            for (auto cell = firstCell; cell < m_width * m_height; ++cell)
+            {
+                const auto piece = covered(m_skeletonPieces[i], cell);
+                if (piece != 0 && (piece & occupied) == 0)
+                {
+                    cells[i] = cell;
+                    place(i + 1, occupied | piece, (key << bitsPerCell) | static_cast<std::uint64_t>(cell));
+                }
+            }
+        };
+
+        m_skeletons.clear();
+        place(0, m_forbidden, 0);
+    }
+
+private:
+    std::array<Block, pieceCount> m_pieces;
+    int m_width;
+    int m_height;
+    std::uint64_t m_forbidden;
+
+    // Runner & blocks larger than 1x1, in piece order
+    std::vector<int> m_skeletonPieces;
+
+    // 1x1 blocks
+    std::vector<int> m_fillerPieces;
+
+    // Sorted keys of all skeletons: the cell of every skeleton piece, bitsPerCell bits each
+    std::vector<std::uint64_t> m_skeletons;
+
+    // Ways to place the filler pieces on the free cells of a skeleton
+    std::uint64_t m_combinations;
+
+    // m_binomials[n][k] = n choose k
+    std::array<std::array<std::uint64_t, pieceCount + 1>, 65> m_binomials;
+};
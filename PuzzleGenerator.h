@@ -0,0 +1,324 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "Frontier.h"
+#include "MoveDiscovery.h"
+#include "PlacementRanking.h"
+#include "puzzle.h"
+#include "solver.h"
+
+template <int BlockCount>
+struct GeneratedPuzzle
+{
+    // Hardest layout of its component, m_initialState is the start position
+    Puzzle<BlockCount> m_puzzle;
+
+    // Minimal number of moves needed to solve it
+    int m_distance;
+
+    // Number of layouts reachable from the start position
+    std::size_t m_componentSize;
+};
+
+// Searches all layouts of a set of pieces for the ones furthest away from the goal
+// Every legal placement of the pieces is enumerated & grouped into components of layouts reachable from each other.
+// As moves can be undone, a single BFS from all solved layouts of a component at once
+// yields the distance to the goal of every layout in that component. Components are handled in parallel.
+template <
+    int BlockCount,
+    typename MoveDiscovery
+>
+class PuzzleGenerator
+{
+public:
+    using Index = typename Frontier<BlockCount>::Index;
+
+public:
+    // Board, goal & pieces of family are used, the positions of its pieces are ignored
+    explicit PuzzleGenerator(const Puzzle<BlockCount> &family)
+        : m_family{ family }
+        , m_ranking{ family }
+        , m_placements{ family.m_initialState }
+        , m_indices{}
+        , m_components{}
+        , m_componentCount{ 0 }
+    {
+    }
+
+    // Returns the hardest layout of each component, hardest first, at most count of them
+    std::vector<GeneratedPuzzle<BlockCount>> hardest(std::size_t count, unsigned threads = std::thread::hardware_concurrency())
+    {
+        enumeratePlacements();
+        findComponents();
+
+        // Every component writes the distances of its own layouts only, so they can share a single array
+        std::vector<int> distances(m_placements.size(), -1);
+        std::vector<std::vector<Index>> members(m_componentCount);
+        for (auto index = 0u; index < m_placements.size(); ++index)
+        {
+            members[m_components[index]].push_back(static_cast<Index>(index));
+        }
+
+        std::vector<Index> hardestOfComponent(m_componentCount, 0);
+        std::atomic<std::size_t> nextComponent{ 0 };
+        const auto worker = [&]()
+        {
+            for (auto component = nextComponent++; component < m_componentCount; component = nextComponent++)
+            {
+                hardestOfComponent[component] = distanceToGoal(members[component], distances);
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (auto i = 1u; i < std::max(threads, 1u); ++i)
+        {
+            workers.emplace_back(worker);
+        }
+        worker();
+        for (auto &thread : workers)
+        {
+            thread.join();
+        }
+
+        // Note: Puzzles can't be assigned, so components are ranked before building them
+        std::vector<std::size_t> ranking;
+        for (auto component = 0u; component < m_componentCount; ++component)
+        {
+            if (distances[hardestOfComponent[component]] >= 0)
+            {
+                ranking.push_back(component);
+            }
+        }
+        std::stable_sort(begin(ranking), end(ranking), [&](auto left, auto right)
+        {
+            return distances[hardestOfComponent[left]] > distances[hardestOfComponent[right]];
+        });
+
+        std::vector<GeneratedPuzzle<BlockCount>> puzzles;
+        for (auto i = 0u; i < std::min(count, ranking.size()); ++i)
+        {
+            const auto index = hardestOfComponent[ranking[i]];
+            puzzles.push_back(GeneratedPuzzle<BlockCount>{
+                Puzzle<BlockCount>{ m_family.m_dimensions, m_family.m_goal, m_family.m_forbiddenSpots, m_placements.at(index, 0) },
+                distances[index],
+                members[ranking[i]].size() });
+        }
+        return puzzles;
+    }
+
+    // Number of legal layouts of the pieces, available after hardest()
+    std::size_t placementCount() const
+    {
+        return m_placements.size();
+    }
+
+    // Number of layouts which can be looked up by their rank, equal to placementCount() as ranks are unique
+    std::size_t indexedPlacements() const
+    {
+        return m_indices.size();
+    }
+
+    // Number of groups of layouts reachable from each other, available after hardest()
+    std::size_t componentCount() const
+    {
+        return m_componentCount;
+    }
+
+private:
+    // Places every piece on every free cell, by backtracking over the pieces
+    // Blocks of the same size are interchangeable, so each one is only placed after the previous one of its size
+    void enumeratePlacements()
+    {
+        const auto width = m_family.m_dimensions.m_x;
+        const auto height = m_family.m_dimensions.m_y;
+
+        std::vector<char> occupied(width * height, 0);
+        for (const auto &spot : m_family.m_forbiddenSpots)
+        {
+            occupied[spot.m_x * height + spot.m_y] = 1;
+        }
+
+        std::array<Block, BlockCount + 1> pieces{};
+        std::array<int, BlockCount + 1> previousOfSize{};
+        std::array<int, BlockCount + 1> cells{};
+        pieces[0] = m_family.m_initialState.m_runner;
+        previousOfSize[0] = -1;
+        for (auto i = 0; i < BlockCount; ++i)
+        {
+            pieces[i + 1] = m_family.m_initialState.m_blocks[i];
+            previousOfSize[i + 1] = -1;
+            for (auto j = i; j > 0; --j)
+            {
+                if (pieces[j].m_sizeX == pieces[i + 1].m_sizeX && pieces[j].m_sizeY == pieces[i + 1].m_sizeY)
+                {
+                    previousOfSize[i + 1] = j;
+                    break;
+                }
+            }
+        }
+
+        const auto fill = [&](const Block &block, int cell, char value)
+        {
+            const auto x = cell / height;
+            const auto y = cell % height;
+            if (x + block.m_sizeX > width || y + block.m_sizeY > height)
+            {
+                return false;
+            }
+            for (auto dx = 0; dx < block.m_sizeX; ++dx)
+            {
+                for (auto dy = 0; dy < block.m_sizeY; ++dy)
+                {
+                    if (value != 0 && occupied[(x + dx) * height + y + dy] != 0)
+                    {
+                        return false;
+                    }
+                }
+            }
+            for (auto dx = 0; dx < block.m_sizeX; ++dx)
+            {
+                for (auto dy = 0; dy < block.m_sizeY; ++dy)
+                {
+                    occupied[(x + dx) * height + y + dy] = value;
+                }
+            }
+            return true;
+        };
+
+        const auto record = [&]()
+        {
+            std::array<Block, BlockCount> blocks{};
+            for (auto i = 0; i < BlockCount; ++i)
+            {
+                blocks[i] = Block{ cells[i + 1] / height, cells[i + 1] % height, pieces[i + 1].m_sizeX, pieces[i + 1].m_sizeY, pieces[i + 1].id };
+            }
+            const BoardState<BlockCount> state{ 0, Block{ cells[0] / height, cells[0] % height, pieces[0].m_sizeX, pieces[0].m_sizeY, pieces[0].id }, blocks };
+            m_indices.emplace(m_ranking.rank(state), static_cast<Index>(m_placements.size()));
+            m_placements.push_back(state);
+        };
+
+        std::function<void(int)> place = [&](int piece)
+        {
+            if (piece == BlockCount + 1)
+            {
+                record();
+                return;
+            }
+
+            const auto firstCell = previousOfSize[piece] < 0 ? 0 : cells[previousOfSize[piece]] + 1;
+            for (auto cell = firstCell; cell < width * height; ++cell)
+            {
+                if (fill(pieces[piece], cell, 1))
+                {
+                    cells[piece] = cell;
+                    place(piece + 1);
+                    fill(pieces[piece], cell, 0);
+                }
+            }
+        };
+
+        m_placements.clear();
+        m_indices.clear();
+        place(0);
+    }
+
+    template <typename Visit>
+    void forEachNeighbour(Index index, Visit visit) const
+    {
+        const auto state = std::make_shared<BoardState<BlockCount>>(m_placements.at(index, 0));
+        for (auto &move : MoveDiscovery::gatherMoves(m_family.m_dimensions, state, m_family.m_forbiddenSpots))
+        {
+            visit(m_indices.at(m_ranking.rank(move())));
+        }
+    }
+
+    // Labels every placement with the component it belongs to
+    void findComponents()
+    {
+        constexpr auto unlabeled = -1;
+        m_components.assign(m_placements.size(), unlabeled);
+        m_componentCount = 0;
+
+        std::vector<Index> queue;
+        for (auto start = 0u; start < m_placements.size(); ++start)
+        {
+            if (m_components[start] != unlabeled)
+            {
+                continue;
+            }
+
+            const auto component = static_cast<int>(m_componentCount++);
+            m_components[start] = component;
+            queue.assign(1, static_cast<Index>(start));
+            for (auto next = 0u; next < queue.size(); ++next)
+            {
+                forEachNeighbour(queue[next], [&](Index neighbour)
+                {
+                    if (m_components[neighbour] == unlabeled)
+                    {
+                        m_components[neighbour] = component;
+                        queue.push_back(neighbour);
+                    }
+                });
+            }
+        }
+    }
+
+    // Multi-source BFS from all solved layouts of a component, returns its layout furthest from the goal
+    Index distanceToGoal(const std::vector<Index> &members, std::vector<int> &distances) const
+    {
+        std::vector<Index> queue;
+        for (const auto index : members)
+        {
+            if (isSolution(m_placements.at(index, 0), m_family.m_goal))
+            {
+                distances[index] = 0;
+                queue.push_back(index);
+            }
+        }
+
+        for (auto next = 0u; next < queue.size(); ++next)
+        {
+            forEachNeighbour(queue[next], [&](Index neighbour)
+            {
+                if (distances[neighbour] < 0)
+                {
+                    distances[neighbour] = distances[queue[next]] + 1;
+                    queue.push_back(neighbour);
+                }
+            });
+        }
+
+        // BFS order: the last layout reached is the furthest away
+        return queue.empty() ? members.front() : queue.back();
+    }
+
+private:
+    const Puzzle<BlockCount> m_family;
+
+    // Exact key of every layout: hashes of different layouts can collide, linking unrelated layouts
+    PlacementRanking<BlockCount> m_ranking;
+
+    // Every legal layout of the pieces & where to find it by rank
+    Frontier<BlockCount> m_placements;
+    std::unordered_map<std::uint64_t, Index> m_indices;
+
+    // Component of every layout
+    std::vector<int> m_components;
+    std::size_t m_componentCount;
+};
+
+template <int BlockCount, typename MoveDiscovery = MoveRunnerFirst<>>
+PuzzleGenerator<BlockCount, MoveDiscovery> makePuzzleGenerator(const Puzzle<BlockCount> &family)
+{
+    return PuzzleGenerator<BlockCount, MoveDiscovery>{ family };
+}
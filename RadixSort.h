@@ -0,0 +1,75 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include "Parallel.h"
+
+// Least significant digit radix sort of the lowest keyBits bits of unsigned keys, 8 bits per pass
+// Every pass splits keys into one slice per thread: each thread counts the digits of its slice,
+// the counts are turned into the offset of every digit of every slice, & each thread then scatters
+// its slice to its own offsets. Passes over a digit which is the same for all keys are skipped.
+// scratch is only used as a buffer, so it can be reused over calls to save allocations.
+template <typename Key>
+void radixSort(std::vector<Key> &keys, std::vector<Key> &scratch, int keyBits, unsigned threads = 1)
+{
+    constexpr auto digitBits = 8;
+    constexpr auto digits = std::size_t{ 1 } << digitBits;
+
+    // Threads don't pay off for small inputs
+    constexpr auto minimumSlice = std::size_t{ 1 } << 14;
+    threads = static_cast<unsigned>(std::max<std::size_t>(1, std::min<std::size_t>(threads, keys.size() / minimumSlice)));
+
+    const auto sliceSize = (keys.size() + threads - 1) / threads;
+    const auto sliceBegin = [&](unsigned worker) { return std::min(keys.size(), worker * sliceSize); };
+    const auto sliceEnd = [&](unsigned worker) { return std::min(keys.size(), (worker + 1) * sliceSize); };
+
+    scratch.resize(keys.size());
+    std::vector<std::array<std::size_t, digits>> offsets(threads);
+    for (auto shift = 0; shift < keyBits; shift += digitBits)
+    {
+        const auto digitOf = [shift](Key key) { return static_cast<std::size_t>(key >> shift) & (digits - 1); };
+
+        detail::forEachWorker(threads, [&](unsigned worker)
+        {
+            auto &counts = offsets[worker];
+            counts.fill(0);
+            for (auto i = sliceBegin(worker); i < sliceEnd(worker); ++i)
+            {
+                ++counts[digitOf(keys[i])];
+            }
+        });
+
+        // Digit by digit, slice by slice, so equal digits keep their order
+        std::size_t offset = 0;
+        auto sameDigit = false;
+        for (auto digit = 0u; digit < digits; ++digit)
+        {
+            std::size_t count = 0;
+            for (auto &counts : offsets)
+            {
+                count += counts[digit];
+                const auto start = offset;
+                offset += counts[digit];
+                counts[digit] = start;
+            }
+            sameDigit = sameDigit || count == keys.size();
+        }
+        if (sameDigit)
+        {
+            continue;
+        }
+
+        detail::forEachWorker(threads, [&](unsigned worker)
+        {
+            auto &next = offsets[worker];
+            for (auto i = sliceBegin(worker); i < sliceEnd(worker); ++i)
+            {
+                scratch[next[digitOf(keys[i])]++] = keys[i];
+            }
+        });
+        keys.swap(scratch);
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Minimal binary (de)serialization helpers for checkpoints
+// Note: values are written in native byte order, checkpoints are not meant to move between architectures
+namespace serialization
+{
+    template <typename T>
+    void write(std::ostream &out, const T &value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable values can be written as-is");
+        out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    void read(std::istream &in, T &value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable values can be read as-is");
+        in.read(reinterpret_cast<char *>(&value), sizeof(T));
+        if (!in)
+        {
+            throw std::runtime_error("Unexpected end of serialized data");
+        }
+    }
+
+    template <typename T>
+    T read(std::istream &in)
+    {
+        T value{};
+        read(in, value);
+        return value;
+    }
+
+    template <typename T, typename Allocator>
+    void writeVector(std::ostream &out, const std::vector<T, Allocator> &values)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable values can be written as-is");
+        write(out, static_cast<std::uint64_t>(values.size()));
+        out.write(reinterpret_cast<const char *>(values.data()), values.size() * sizeof(T));
+    }
+
+    template <typename T, typename Allocator>
+    void readVector(std::istream &in, std::vector<T, Allocator> &values)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable values can be read as-is");
+        values.resize(static_cast<std::size_t>(read<std::uint64_t>(in)));
+        in.read(reinterpret_cast<char *>(values.data()), values.size() * sizeof(T));
+        if (!in)
+        {
+            throw std::runtime_error("Unexpected end of serialized data");
+        }
+    }
+
+    // Throws if the next value in the stream isn't the expected one
+    template <typename T>
+    void expect(std::istream &in, const T &expected, const char *what)
+    {
+        if (read<T>(in) != expected)
+        {
+            throw std::runtime_error(std::string("Serialized data does not match: ") + what);
+        }
+    }
+}
@@ -0,0 +1,156 @@
+#include "SolutionCache.h"
+
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <thread>
+
+#include "Serialization.h"
+
+namespace
+{
+    constexpr std::uint32_t solutionMagic = 0x4c4f'534b; // "KSOL"
+}
+
+SolutionCache::SolutionCache(std::size_t capacity, std::string directory)
+    : m_capacity{ capacity }
+    , m_directory{ std::move(directory) }
+    , m_mutex{}
+    , m_entries{}
+    , m_index{}
+    , m_stats{}
+{
+}
+
+bool SolutionCache::find(const PuzzleFingerprint &fingerprint, Solution &solution)
+{
+    {
+        std::lock_guard<std::mutex> lock{ m_mutex };
+        const auto entry = m_index.find(fingerprint.m_value);
+        if (entry != end(m_index) && entry->second->m_description == fingerprint.m_description)
+        {
+            // Move to the front, as most recently used
+            m_entries.splice(begin(m_entries), m_entries, entry->second);
+            solution = entry->second->m_solution;
+            ++m_stats.m_memoryHits;
+            return true;
+        }
+    }
+
+    // Note: disk is read without holding the lock, so other lookups aren't held up
+    if (readFromDisk(fingerprint, solution))
+    {
+        std::lock_guard<std::mutex> lock{ m_mutex };
+        insertInMemory(Entry{ fingerprint.m_value, fingerprint.m_description, solution });
+        ++m_stats.m_diskHits;
+        return true;
+    }
+
+    std::lock_guard<std::mutex> lock{ m_mutex };
+    ++m_stats.m_misses;
+    return false;
+}
+
+void SolutionCache::insert(const PuzzleFingerprint &fingerprint, const Solution &solution)
+{
+    writeToDisk(fingerprint, solution);
+
+    std::lock_guard<std::mutex> lock{ m_mutex };
+    insertInMemory(Entry{ fingerprint.m_value, fingerprint.m_description, solution });
+}
+
+CacheStats SolutionCache::stats() const
+{
+    std::lock_guard<std::mutex> lock{ m_mutex };
+    return m_stats;
+}
+
+void SolutionCache::insertInMemory(Entry entry)
+{
+    if (m_capacity == 0)
+    {
+        return;
+    }
+
+    const auto existing = m_index.find(entry.m_fingerprint);
+    if (existing != end(m_index))
+    {
+        m_entries.erase(existing->second);
+        m_index.erase(existing);
+    }
+
+    m_entries.push_front(std::move(entry));
+    m_index[m_entries.front().m_fingerprint] = begin(m_entries);
+
+    if (m_entries.size() > m_capacity)
+    {
+        m_index.erase(m_entries.back().m_fingerprint);
+        m_entries.pop_back();
+        ++m_stats.m_evictions;
+    }
+}
+
+std::string SolutionCache::pathOf(std::uint64_t fingerprint) const
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.sol", static_cast<unsigned long long>(fingerprint));
+    return m_directory + "/" + name;
+}
+
+bool SolutionCache::readFromDisk(const PuzzleFingerprint &fingerprint, Solution &solution) const
+{
+    if (m_directory.empty())
+    {
+        return false;
+    }
+
+    std::ifstream in{ pathOf(fingerprint.m_value), std::ios::binary };
+    if (!in)
+    {
+        return false;
+    }
+
+    try
+    {
+        std::vector<int> description;
+        serialization::expect(in, solutionMagic, "not a solution");
+        serialization::readVector(in, description);
+        if (description != fingerprint.m_description)
+        {
+            // Another puzzle with the same fingerprint
+            return false;
+        }
+        serialization::read(in, solution.m_distance);
+        serialization::readVector(in, solution.m_moves);
+        return true;
+    }
+    catch (const std::runtime_error &)
+    {
+        // Truncated or corrupt file, solve again
+        return false;
+    }
+}
+
+void SolutionCache::writeToDisk(const PuzzleFingerprint &fingerprint, const Solution &solution) const
+{
+    if (m_directory.empty())
+    {
+        return;
+    }
+
+    // Written to a temporary file first, so readers never see a partially written solution
+    const auto path = pathOf(fingerprint.m_value);
+    const auto temporaryPath = path + "." + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id())) + ".tmp";
+    {
+        std::ofstream out{ temporaryPath, std::ios::binary | std::ios::trunc };
+        serialization::write(out, solutionMagic);
+        serialization::writeVector(out, fingerprint.m_description);
+        serialization::write(out, solution.m_distance);
+        serialization::writeVector(out, solution.m_moves);
+        if (!out)
+        {
+            return;
+        }
+    }
+    std::rename(temporaryPath.c_str(), path.c_str());
+}
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "BoardHasher.h"
+#include "Fingerprint.h"
+#include "MoveDiscovery.h"
+#include "solver.h"
+
+// Single move of a solution, identified by the position of the block before the move
+struct SolutionMove
+{
+    int m_x;
+    int m_y;
+
+    // Width of the moved block, to mirror the move
+    int m_width;
+
+    Direction m_direction;
+};
+
+struct Solution
+{
+    // Number of moves to the goal, -1 if it can't be reached
+    int m_distance;
+
+    std::vector<SolutionMove> m_moves;
+};
+
+struct CacheStats
+{
+    std::size_t m_memoryHits;
+    std::size_t m_diskHits;
+    std::size_t m_misses;
+    std::size_t m_evictions;
+};
+
+// Two-tier cache of solutions by puzzle fingerprint: least recently used solutions are kept in memory,
+// & when a directory is given every solution is also stored on disk, one file per fingerprint.
+// Solutions are stored for the canonical orientation of the fingerprint.
+// Thread-safe
+class SolutionCache
+{
+public:
+    explicit SolutionCache(std::size_t capacity, std::string directory = {});
+
+    bool find(const PuzzleFingerprint &fingerprint, Solution &solution);
+    void insert(const PuzzleFingerprint &fingerprint, const Solution &solution);
+
+    CacheStats stats() const;
+
+private:
+    struct Entry
+    {
+        std::uint64_t m_fingerprint;
+        std::vector<int> m_description;
+        Solution m_solution;
+    };
+
+    // Expects m_mutex to be locked
+    void insertInMemory(Entry entry);
+
+    std::string pathOf(std::uint64_t fingerprint) const;
+    bool readFromDisk(const PuzzleFingerprint &fingerprint, Solution &solution) const;
+    void writeToDisk(const PuzzleFingerprint &fingerprint, const Solution &solution) const;
+
+private:
+    const std::size_t m_capacity;
+    const std::string m_directory;
+
+    mutable std::mutex m_mutex;
+
+    // Most recently used first
+    std::list<Entry> m_entries;
+    std::unordered_map<std::uint64_t, std::list<Entry>::iterator> m_index;
+
+    CacheStats m_stats;
+};
+
+namespace detail
+{
+    // Converts moves between the orientation of a puzzle & its mirror image
+    inline std::vector<SolutionMove> mirror(std::vector<SolutionMove> moves, int boardWidth)
+    {
+        for (auto &move : moves)
+        {
+            move.m_x = boardWidth - move.m_x - move.m_width;
+            move.m_direction = move.m_direction == Left ? Right
+                : move.m_direction == Right ? Left
+                : move.m_direction;
+        }
+        return moves;
+    }
+
+    template <int BlockCount>
+    SolutionMove moveBetween(const BoardState<BlockCount> &from, const BoardState<BlockCount> &to)
+    {
+        const auto between = [](const Block &before, const Block &after)
+        {
+            const auto direction = after.m_startX > before.m_startX ? Right
+                : after.m_startX < before.m_startX ? Left
+                : after.m_startY > before.m_startY ? Down
+                : Up;
+            return SolutionMove{ before.m_startX, before.m_startY, before.m_sizeX, direction };
+        };
+
+        if (!equalPosition(from.m_runner, to.m_runner))
+        {
+            return between(from.m_runner, to.m_runner);
+        }
+        for (auto i = 0; i < BlockCount; ++i)
+        {
+            if (!equalPosition(from.m_blocks[i], to.m_blocks[i]))
+            {
+                return between(from.m_blocks[i], to.m_blocks[i]);
+            }
+        }
+        throw std::runtime_error("States are not a single move apart");
+    }
+}
+
+// Solves the puzzle, or looks up the solution of an identical or mirrored puzzle solved before
+// Moves of the returned solution are in the orientation of puzzle
+// Throws when the search runs out of budget, nothing is cached then
+template <int BlockCount, typename MoveDiscovery = MoveRunnerFirst<>>
+Solution solveWithCache(const Puzzle<BlockCount> &puzzle, SolutionCache &cache, const BoardHasher<> &hasher, const SearchBudget &budget = SearchBudget{})
+{
+    const auto key = fingerprint(puzzle);
+    const auto width = puzzle.m_dimensions.m_x;
+
+    Solution solution{};
+    if (cache.find(key, solution))
+    {
+        if (key.m_mirrored)
+        {
+            solution.m_moves = detail::mirror(std::move(solution.m_moves), width);
+        }
+        return solution;
+    }
+
+    Solver<BlockCount, MoveDiscovery> solver{ puzzle, hasher };
+    const auto result = solver.solveForGoals(std::vector<Block>{ puzzle.m_goal }, budget).front();
+    if (result.m_status == SearchStatus::OutOfBudget)
+    {
+        throw std::runtime_error("Search ran out of budget");
+    }
+
+    solution.m_distance = result.m_distance;
+    for (auto step = 1u; step < result.m_path.size(); ++step)
+    {
+        solution.m_moves.push_back(detail::moveBetween(result.m_path[step - 1], result.m_path[step]));
+    }
+
+    cache.insert(key, Solution{ solution.m_distance, key.m_mirrored ? detail::mirror(solution.m_moves, width) : solution.m_moves });
+    return solution;
+}
+
+template <int BlockCount, typename MoveDiscovery = MoveRunnerFirst<>>
+Solution solveWithCache(const Puzzle<BlockCount> &puzzle, SolutionCache &cache, const SearchBudget &budget = SearchBudget{})
+{
+    return solveWithCache<BlockCount, MoveDiscovery>(puzzle, cache, BoardHasher<>{ puzzle }, budget);
+}
@@ -0,0 +1,271 @@
+#include "SolverService.h"
+
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+#include "MoveDiscovery.h"
+#include "MoveValidation.h"
+#include "solver.h"
+
+static_assert(SolverService::maxDimension <= std::numeric_limits<Frontier<0>::Coordinate>::max(),
+    "Positions of the largest puzzle must fit in a Frontier");
+
+namespace
+{
+    // Instantiates SolverService::solve for every supported block count, picking the one matching the request
+    template <int BlockCount, int MaxBlockCount>
+    struct SolveDispatch
+    {
+        static std::string solve(SolverService &service, const PuzzleDescription &description)
+        {
+            if (static_cast<int>(description.m_blocks.size()) == BlockCount)
+            {
+                return service.solve<BlockCount>(description);
+            }
+            return SolveDispatch<BlockCount + 1, MaxBlockCount>::solve(service, description);
+        }
+    };
+
+    template <int MaxBlockCount>
+    struct SolveDispatch<MaxBlockCount, MaxBlockCount>
+    {
+        static std::string solve(SolverService &service, const PuzzleDescription &description)
+        {
+            if (static_cast<int>(description.m_blocks.size()) == MaxBlockCount)
+            {
+                return service.solve<MaxBlockCount>(description);
+            }
+            return "ERR too many blocks";
+        }
+    };
+
+    // Reads "SOLVE ..." requests, see README.md for the format
+    bool parseSolveRequest(std::istream &in, PuzzleDescription &description)
+    {
+        auto count = 0;
+        if (!(in >> description.m_dimensions.m_x >> description.m_dimensions.m_y
+            >> description.m_goal.m_x >> description.m_goal.m_y
+            >> count) || count < 0
+            || description.m_dimensions.m_x > SolverService::maxDimension
+            || description.m_dimensions.m_y > SolverService::maxDimension)
+        {
+            return false;
+        }
+        for (auto i = 0; i < count; ++i)
+        {
+            Point spot{};
+            if (!(in >> spot.m_x >> spot.m_y))
+            {
+                return false;
+            }
+            description.m_forbiddenSpots.push_back(spot);
+        }
+
+        auto &runner = description.m_runner;
+        runner.id = "@";
+        if (!(in >> runner.m_startX >> runner.m_startY >> runner.m_sizeX >> runner.m_sizeY >> count)
+            || count < 0 || count > SolverService::maxBlockCount)
+        {
+            return false;
+        }
+        for (auto i = 0; i < count; ++i)
+        {
+            Block block{ 0, 0, 0, 0, std::string(1, static_cast<char>('A' + i)) };
+            if (!(in >> block.m_startX >> block.m_startY >> block.m_sizeX >> block.m_sizeY))
+            {
+                return false;
+            }
+            description.m_blocks.push_back(block);
+        }
+
+        std::string trailing;
+        return !(in >> trailing);
+    }
+
+    const char *directionName(Direction direction)
+    {
+        switch (direction)
+        {
+        case Up:
+            return "U";
+        case Down:
+            return "D";
+        case Left:
+            return "L";
+        case Right:
+            return "R";
+        default:
+            return "?";
+        }
+    }
+}
+
+SolverService::SolverService(std::size_t cacheCapacity, std::string cacheDirectory, SearchBudget budget, std::size_t familyCapacity)
+    : m_metrics{}
+    , m_familyCapacity{ familyCapacity }
+    , m_familiesMutex{}
+    , m_families{}
+    , m_familyIndex{}
+    , m_solutions{ cacheCapacity, std::move(cacheDirectory) }
+    , m_budget{ budget }
+{
+}
+
+std::string SolverService::handle(const std::string &request)
+{
+    ++m_metrics.m_requests;
+
+    std::istringstream in{ request };
+    std::string command;
+    in >> command;
+
+    if (command == "STATS")
+    {
+        return stats();
+    }
+
+    PuzzleDescription description{};
+    if (command != "SOLVE" || !parseSolveRequest(in, description))
+    {
+        ++m_metrics.m_errors;
+        return "ERR malformed request";
+    }
+
+    std::string response;
+    try
+    {
+        response = SolveDispatch<0, maxBlockCount>::solve(*this, description);
+    }
+    catch (const std::runtime_error &error)
+    {
+        response = std::string{ "ERR " } + error.what();
+    }
+    if (response.compare(0, 3, "ERR") == 0)
+    {
+        ++m_metrics.m_errors;
+    }
+    return response;
+}
+
+ServiceMetrics &SolverService::metrics()
+{
+    return m_metrics;
+}
+
+CacheStats SolverService::cacheStats() const
+{
+    return m_solutions.stats();
+}
+
+template <int BlockCount>
+std::string SolverService::solve(const PuzzleDescription &description)
+{
+    std::array<Block, BlockCount> blocks{};
+    std::copy(begin(description.m_blocks), end(description.m_blocks), begin(blocks));
+
+    const auto &runner = description.m_runner;
+    const Puzzle<BlockCount> puzzle{
+        description.m_dimensions,
+        Block{ description.m_goal.m_x, description.m_goal.m_y, runner.m_sizeX, runner.m_sizeY, "$" },
+        description.m_forbiddenSpots,
+        BoardState<BlockCount>{ 0, runner, blocks } };
+
+    const auto &state = puzzle.m_initialState;
+    const auto placedLegally = [&](const Block &block)
+    {
+        return block.m_sizeX > 0 && block.m_sizeY > 0
+            && DefaultMoveValidation::validBlockPosition(block, puzzle.m_dimensions, state, puzzle.m_forbiddenSpots);
+    };
+    if (puzzle.m_dimensions.m_x <= 0 || puzzle.m_dimensions.m_y <= 0
+        || !valid(puzzle)
+        || !placedLegally(state.m_runner)
+        || !std::all_of(begin(state.m_blocks), end(state.m_blocks), placedLegally))
+    {
+        return "ERR invalid puzzle";
+    }
+
+    const auto hasher = familyHasher(puzzle);
+    const auto solution = solveWithCache(puzzle, m_solutions, *hasher, m_budget);
+
+    // Replay the solution to name the moved blocks
+    std::vector<Block> pieces{ state.m_runner };
+    pieces.insert(end(pieces), begin(state.m_blocks), end(state.m_blocks));
+
+    std::ostringstream response;
+    response << "OK " << solution.m_distance;
+    for (const auto &step : solution.m_moves)
+    {
+        const auto piece = std::find_if(begin(pieces), end(pieces), [&](const Block &block)
+        {
+            return block.m_startX == step.m_x && block.m_startY == step.m_y;
+        });
+        if (piece == end(pieces))
+        {
+            return "ERR cached solution doesn't match the puzzle";
+        }
+        response << ' ' << piece->id << directionName(step.m_direction);
+        *piece = move(*piece, step.m_direction);
+    }
+    return response.str();
+}
+
+std::string SolverService::stats() const
+{
+    std::ostringstream response;
+    response << "OK"
+        << " queued=" << m_metrics.m_queueDepth
+        << " maxQueued=" << m_metrics.m_maxQueueDepth
+        << " rejected=" << m_metrics.m_rejected
+        << " activeWorkers=" << m_metrics.m_activeWorkers
+        << " requests=" << m_metrics.m_requests
+        << " errors=" << m_metrics.m_errors
+        << " familyHits=" << m_metrics.m_familyHits
+        << " familyEvictions=" << m_metrics.m_familyEvictions;
+
+    const auto cache = m_solutions.stats();
+    response
+        << " memoryHits=" << cache.m_memoryHits
+        << " diskHits=" << cache.m_diskHits
+        << " misses=" << cache.m_misses
+        << " evictions=" << cache.m_evictions;
+    return response.str();
+}
+
+template <int BlockCount>
+std::shared_ptr<const BoardHasher<>> SolverService::familyHasher(const Puzzle<BlockCount> &puzzle)
+{
+    // Hash codes only depend on the dimensions & the sizes of the blocks, in order
+    std::ostringstream family;
+    family << puzzle.m_dimensions.m_x << 'x' << puzzle.m_dimensions.m_y;
+    for (const auto &block : puzzle.m_initialState.m_blocks)
+    {
+        family << ' ' << block.m_sizeX << 'x' << block.m_sizeY;
+    }
+
+    std::lock_guard<std::mutex> lock{ m_familiesMutex };
+    const auto known = m_familyIndex.find(family.str());
+    if (known != end(m_familyIndex))
+    {
+        // Move to the front, as most recently used
+        m_families.splice(begin(m_families), m_families, known->second);
+        ++m_metrics.m_familyHits;
+        return known->second->second;
+    }
+
+    // Searches still using an evicted hasher keep it alive through their own reference
+    const auto hasher = std::make_shared<const BoardHasher<>>(puzzle);
+    if (m_familyCapacity == 0)
+    {
+        return hasher;
+    }
+    m_families.emplace_front(family.str(), hasher);
+    m_familyIndex[family.str()] = begin(m_families);
+    if (m_families.size() > m_familyCapacity)
+    {
+        m_familyIndex.erase(m_families.back().first);
+        m_families.pop_back();
+        ++m_metrics.m_familyEvictions;
+    }
+    return hasher;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "BoardHasher.h"
+#include "block.h"
+#include "SolutionCache.h"
+
+struct ServiceMetrics
+{
+    // Connections waiting for a worker
+    std::atomic<std::size_t> m_queueDepth{ 0 };
+    std::atomic<std::size_t> m_maxQueueDepth{ 0 };
+
+    // Connections turned away because the queue was full
+    std::atomic<std::size_t> m_rejected{ 0 };
+
+    std::atomic<std::size_t> m_activeWorkers{ 0 };
+    std::atomic<std::size_t> m_requests{ 0 };
+    std::atomic<std::size_t> m_errors{ 0 };
+
+    // Requests reusing the hash codes of a known board family
+    std::atomic<std::size_t> m_familyHits{ 0 };
+
+    // Board families whose hash codes were dropped, least recently used first
+    std::atomic<std::size_t> m_familyEvictions{ 0 };
+};
+
+// Puzzle as sent over the line protocol, block count is only known at runtime
+struct PuzzleDescription
+{
+    Point m_dimensions;
+    Point m_goal;
+    std::vector<Point> m_forbiddenSpots;
+    Block m_runner;
+    std::vector<Block> m_blocks;
+};
+
+// Answers requests of the solver daemon's line protocol, see README.md
+// Hash codes of recently used board families & solutions by puzzle fingerprint are kept between requests,
+// so repeated queries don't pay for setting up a solver from scratch.
+// Thread-safe: a single service is shared by all workers of the daemon
+class SolverService
+{
+public:
+    // Largest number of blocks (besides the runner) a puzzle can have
+    constexpr static int maxBlockCount = 15;
+
+    // Largest width & height of a puzzle, positions are stored in 8 bits by Frontier
+    constexpr static int maxDimension = 127;
+
+public:
+    // Keeps cacheCapacity solutions in memory, & all of them in cacheDirectory if one is given
+    // Every search is stopped once it exceeds budget, & answered with an error
+    // Hash codes of up to familyCapacity board families are kept, they take up to a few MB each on the largest boards
+    explicit SolverService(
+        std::size_t cacheCapacity = 1024,
+        std::string cacheDirectory = {},
+        SearchBudget budget = SearchBudget{ std::chrono::seconds{ 60 }, 0 },
+        std::size_t familyCapacity = 64);
+
+    // Handles a single request line, returns the response line without newline
+    std::string handle(const std::string &request);
+
+    ServiceMetrics &metrics();
+    CacheStats cacheStats() const;
+
+    // Solves the puzzle, returns the response line
+    template <int BlockCount>
+    std::string solve(const PuzzleDescription &description);
+
+private:
+    std::string stats() const;
+
+    // Hasher shared by every puzzle with the same dimensions & block sizes
+    template <int BlockCount>
+    std::shared_ptr<const BoardHasher<>> familyHasher(const Puzzle<BlockCount> &puzzle);
+
+private:
+    ServiceMetrics m_metrics;
+
+    using Family = std::pair<std::string, std::shared_ptr<const BoardHasher<>>>;
+
+    const std::size_t m_familyCapacity;
+    std::mutex m_familiesMutex;
+
+    // Most recently used first
+    std::list<Family> m_families;
+    std::unordered_map<std::string, std::list<Family>::iterator> m_familyIndex;
+
+    SolutionCache m_solutions;
+
+    const SearchBudget m_budget;
+};
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <type_traits>
+#include <vector>
+
+#include "MemoryBackend.h"
+#include "Prefetch.h"
+#include "Serialization.h"
+
+// Open addressing hash set of visited board hashes, storing the distance at which each was found
+// Unlike std::unordered_map every bucket lives in one flat array, so the bucket of an upcoming
+// lookup can be prefetched while the current one is being resolved.
+// Board hashes are already uniformly distributed, so buckets are picked from the low bits directly.
+template <typename HashType = int, typename DistanceType = int>
+class VisitedSet
+{
+public:
+    // The table comes from memory, or from operator new without a backend
+    explicit VisitedSet(std::size_t expectedSize = 1024, std::shared_ptr<MemoryBackend> memory = nullptr)
+        : m_entries{ BackendAllocator<Entry>{ std::move(memory) } }
+        , m_size{ 0 }
+    {
+        auto capacity = std::size_t{ 16 };
+        while (capacity < expectedSize * 2)
+        {
+            capacity *= 2;
+        }
+        m_entries.resize(capacity, Entry{ HashType{}, emptyDistance });
+    }
+
+    // Returns true if hash was not known yet
+    bool insert(HashType hash, DistanceType distance)
+    {
+        reserve(m_size + 1);
+        return insertWithoutGrowing(hash, distance);
+    }
+
+    // Batched insert-if-absent, isNew[i] is set to 1 if hashes[i] was not known yet
+    // Buckets are prefetched one batch ahead of the batch being resolved,
+    // so the cache misses of a whole batch overlap instead of stalling one after the other.
+    // Duplicates within the batch are resolved in order: only the first one is new.
+    // The table grows batch by batch, as most hashes of a level are usually known already
+    template <std::size_t BatchSize = 16>
+    void insert(const HashType *hashes, std::size_t count, DistanceType distance, char *isNew)
+    {
+        const auto prefetchBatch = [&](std::size_t start)
+        {
+            for (auto i = start; i < std::min(count, start + BatchSize); ++i)
+            {
+                prefetch(hashes[i]);
+            }
+        };
+
+        prefetchBatch(0);
+        for (std::size_t start = 0; start < count; start += BatchSize)
+        {
+            // At most the whole batch is new, buckets prefetched before growing are stale
+            const auto batchSize = std::min(count - start, BatchSize);
+            if ((m_size + batchSize) * 2 > m_entries.size())
+            {
+                reserve(m_size + batchSize);
+                prefetchBatch(start);
+            }
+
+            prefetchBatch(start + BatchSize);
+            for (auto i = start; i < std::min(count, start + BatchSize); ++i)
+            {
+                isNew[i] = insertWithoutGrowing(hashes[i], distance) ? 1 : 0;
+            }
+        }
+    }
+
+    // Makes room for count entries, so inserting them never rehashes
+    void reserve(std::size_t count)
+    {
+        while (count * 2 > m_entries.size())
+        {
+            grow();
+        }
+    }
+
+    // Returns the distance hash was found at, or a negative number if unknown
+    DistanceType find(HashType hash) const
+    {
+        return probe(hash).m_distance;
+    }
+
+    bool contains(HashType hash) const
+    {
+        return find(hash) != emptyDistance;
+    }
+
+    void prefetch(HashType hash) const
+    {
+        ::prefetch(&m_entries[bucketOf(hash)]);
+    }
+
+    // Only occupied buckets are written, the table is rebuilt when reading
+    void write(std::ostream &out) const
+    {
+        serialization::write(out, static_cast<std::uint64_t>(m_size));
+        for (const auto &entry : m_entries)
+        {
+            if (entry.m_distance != emptyDistance)
+            {
+                serialization::write(out, entry);
+            }
+        }
+    }
+
+    void read(std::istream &in)
+    {
+        const auto size = static_cast<std::size_t>(serialization::read<std::uint64_t>(in));
+        std::fill(begin(m_entries), end(m_entries), Entry{ HashType{}, emptyDistance });
+        m_size = 0;
+        reserve(size);
+        for (auto i = 0u; i < size; ++i)
+        {
+            const auto entry = serialization::read<Entry>(in);
+            insertWithoutGrowing(entry.m_hash, entry.m_distance);
+        }
+    }
+
+    std::size_t size() const { return m_size; }
+    std::size_t capacity() const { return m_entries.size(); }
+
+private:
+    constexpr static DistanceType emptyDistance = -1;
+
+    struct Entry
+    {
+        HashType m_hash;
+        DistanceType m_distance;
+    };
+
+    using Entries = std::vector<Entry, BackendAllocator<Entry>>;
+
+    std::size_t bucketOf(HashType hash) const
+    {
+        using Unsigned = typename std::make_unsigned<HashType>::type;
+        return static_cast<std::size_t>(static_cast<Unsigned>(hash)) & (m_entries.size() - 1);
+    }
+
+    // Linear probing: the bucket holding hash, or the empty bucket where it belongs
+    const Entry &probe(HashType hash) const
+    {
+        auto bucket = bucketOf(hash);
+        while (m_entries[bucket].m_distance != emptyDistance && m_entries[bucket].m_hash != hash)
+        {
+            bucket = (bucket + 1) & (m_entries.size() - 1);
+        }
+        return m_entries[bucket];
+    }
+
+    Entry &probe(HashType hash)
+    {
+        return const_cast<Entry &>(static_cast<const VisitedSet &>(*this).probe(hash));
+    }
+
+    bool insertWithoutGrowing(HashType hash, DistanceType distance)
+    {
+        auto &entry = probe(hash);
+        if (entry.m_distance != emptyDistance)
+        {
+            return false;
+        }
+
+        entry = Entry{ hash, distance };
+        ++m_size;
+        return true;
+    }
+
+    void grow()
+    {
+        Entries old(m_entries.size() * 2, Entry{ HashType{}, emptyDistance }, m_entries.get_allocator());
+        old.swap(m_entries);
+        for (const auto &entry : old)
+        {
+            if (entry.m_distance != emptyDistance)
+            {
+                probe(entry.m_hash) = entry;
+            }
+        }
+    }
+
+private:
+    Entries m_entries;
+    std::size_t m_size;
+};
@@ -0,0 +1,290 @@
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "SolverService.h"
+
+// Long running solver, answering requests on a unix domain socket
+// Every connection is served by a single worker, one response line per request line.
+// Connections wait in a bounded queue for a free worker, when the queue is full they're turned away.
+// Connections idle for longer than idleTimeout, or sending a line longer than maxLineLength, are closed.
+namespace
+{
+    // Longest request line, a SOLVE request of the largest board with every cell forbidden fits easily
+    constexpr std::size_t maxLineLength = std::size_t{ 1 } << 20;
+
+    // Longest wait for a client to send or accept data, reading a request doesn't count towards solving it
+    constexpr auto idleTimeout = std::chrono::seconds{ 60 };
+
+    // Wait after accept() fails for lack of resources (e.g. EMFILE), until connections are closed
+    constexpr auto acceptBackoff = std::chrono::seconds{ 1 };
+
+    volatile std::sig_atomic_t stopRequested = 0;
+
+    void requestStop(int)
+    {
+        stopRequested = 1;
+    }
+
+    bool writeLine(int connection, std::string line)
+    {
+        line += '\n';
+        for (std::size_t written = 0; written < line.size();)
+        {
+            const auto result = ::write(connection, line.data() + written, line.size() - written);
+            if (result < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (result <= 0)
+            {
+                return false;
+            }
+            written += static_cast<std::size_t>(result);
+        }
+        return true;
+    }
+
+    // Reads from connection, retrying reads interrupted by a signal
+    // Returns 0 once the client is gone, the connection timed out or was shut down, see ConnectionQueue::stop
+    ssize_t receive(int connection, char *buffer, std::size_t size)
+    {
+        auto received = ::read(connection, buffer, size);
+        while (received < 0 && errno == EINTR && !stopRequested)
+        {
+            received = ::read(connection, buffer, size);
+        }
+        return received > 0 ? received : 0;
+    }
+
+    void serve(int connection, SolverService &service)
+    {
+        std::string buffer;
+        char chunk[4096];
+        for (auto received = receive(connection, chunk, sizeof(chunk)); received > 0; received = receive(connection, chunk, sizeof(chunk)))
+        {
+            buffer.append(chunk, static_cast<std::size_t>(received));
+            if (buffer.size() > maxLineLength && buffer.find('\n') > maxLineLength)
+            {
+                ++service.metrics().m_errors;
+                writeLine(connection, "ERR line too long");
+                return;
+            }
+
+            for (auto end = buffer.find('\n'); end != std::string::npos; end = buffer.find('\n'))
+            {
+                const auto request = buffer.substr(0, end);
+                buffer.erase(0, end + 1);
+                std::string response;
+                try
+                {
+                    response = service.handle(request);
+                }
+                catch (const std::exception &)
+                {
+                    // e.g. out of memory, the connection & the other workers can carry on
+                    ++service.metrics().m_errors;
+                    response = "ERR internal error";
+                }
+                if (!writeLine(connection, response))
+                {
+                    return;
+                }
+            }
+        }
+    }
+
+    class ConnectionQueue
+    {
+    public:
+        ConnectionQueue(std::size_t capacity, ServiceMetrics &metrics)
+            : m_capacity{ capacity }
+            , m_metrics{ metrics }
+        {
+        }
+
+        // Returns false if the queue is full
+        bool push(int connection)
+        {
+            std::lock_guard<std::mutex> lock{ m_mutex };
+            if (m_connections.size() >= m_capacity)
+            {
+                return false;
+            }
+
+            m_connections.push_back(connection);
+            m_metrics.m_queueDepth = m_connections.size();
+            if (m_connections.size() > m_metrics.m_maxQueueDepth)
+            {
+                m_metrics.m_maxQueueDepth = m_connections.size();
+            }
+            m_available.notify_one();
+            return true;
+        }
+
+        // Blocks until a connection is available, returns -1 once stopped
+        // The connection is served until it is passed to close()
+        int pop()
+        {
+            std::unique_lock<std::mutex> lock{ m_mutex };
+            m_available.wait(lock, [&]() { return m_stopped || !m_connections.empty(); });
+            if (m_stopped)
+            {
+                return -1;
+            }
+
+            const auto connection = m_connections.front();
+            m_connections.pop_front();
+            m_metrics.m_queueDepth = m_connections.size();
+            m_served.insert(connection);
+            return connection;
+        }
+
+        // Closed under the lock, so stop() never shuts down a reused descriptor
+        void close(int connection)
+        {
+            std::lock_guard<std::mutex> lock{ m_mutex };
+            m_served.erase(connection);
+            ::close(connection);
+        }
+
+        // Closes the queued connections & shuts down the ones being served, so their workers stop reading
+        void stop()
+        {
+            std::lock_guard<std::mutex> lock{ m_mutex };
+            m_stopped = true;
+            for (const auto connection : m_connections)
+            {
+                ::close(connection);
+            }
+            m_connections.clear();
+            m_metrics.m_queueDepth = 0;
+            for (const auto connection : m_served)
+            {
+                ::shutdown(connection, SHUT_RDWR);
+            }
+            m_available.notify_all();
+        }
+
+    private:
+        const std::size_t m_capacity;
+        ServiceMetrics &m_metrics;
+
+        std::mutex m_mutex;
+        std::condition_variable m_available;
+        std::deque<int> m_connections;
+        std::unordered_set<int> m_served;
+        bool m_stopped = false;
+    };
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <socket path> [workers] [max queued connections] [cache directory] [seconds per search]" << std::endl;
+        return 1;
+    }
+
+    const std::string socketPath = argv[1];
+    const auto workerCount = argc > 2 ? std::stoul(argv[2]) : std::max(1u, std::thread::hardware_concurrency());
+    const auto queueCapacity = argc > 3 ? std::stoul(argv[3]) : 64ul;
+    const std::string cacheDirectory = argc > 4 ? argv[4] : "";
+    const auto secondsPerSearch = argc > 5 ? std::stol(argv[5]) : 60l;
+
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path))
+    {
+        std::cerr << "Socket path too long: " << socketPath << std::endl;
+        return 1;
+    }
+    std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+    const auto listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    ::unlink(socketPath.c_str());
+    if (listener < 0
+        || ::bind(listener, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0
+        || ::listen(listener, SOMAXCONN) != 0)
+    {
+        std::cerr << "Could not listen on " << socketPath << ": " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+
+    // No SA_RESTART, so accept() gets interrupted when asked to stop
+    struct sigaction stopAction{};
+    stopAction.sa_handler = requestStop;
+    ::sigaction(SIGINT, &stopAction, nullptr);
+    ::sigaction(SIGTERM, &stopAction, nullptr);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    SolverService service{ 1024, cacheDirectory, SearchBudget{ std::chrono::seconds{ secondsPerSearch }, 0 } };
+    ConnectionQueue queue{ queueCapacity, service.metrics() };
+
+    std::vector<std::thread> workers;
+    for (auto i = 0ul; i < workerCount; ++i)
+    {
+        workers.emplace_back([&]()
+        {
+            for (auto connection = queue.pop(); connection >= 0; connection = queue.pop())
+            {
+                ++service.metrics().m_activeWorkers;
+                serve(connection, service);
+                --service.metrics().m_activeWorkers;
+                queue.close(connection);
+            }
+        });
+    }
+
+    std::cout << "Listening on " << socketPath << " with " << workerCount << " workers" << std::endl;
+    while (!stopRequested)
+    {
+        const auto connection = ::accept(listener, nullptr, nullptr);
+        if (connection < 0)
+        {
+            if (errno != EINTR && errno != ECONNABORTED)
+            {
+                std::cerr << "Could not accept a connection: " << std::strerror(errno) << std::endl;
+                std::this_thread::sleep_for(acceptBackoff);
+            }
+            continue;
+        }
+
+        timeval timeout{};
+        timeout.tv_sec = static_cast<decltype(timeout.tv_sec)>(idleTimeout.count());
+        ::setsockopt(connection, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        ::setsockopt(connection, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+        if (!queue.push(connection))
+        {
+            ++service.metrics().m_rejected;
+            writeLine(connection, "ERR busy");
+            ::close(connection);
+        }
+    }
+
+    queue.stop();
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+    ::close(listener);
+    ::unlink(socketPath.c_str());
+    return 0;
+}
@@ -0,0 +1,54 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "solver.h"
+
+// Benchmark of level deduplication: solves the standard klotski puzzle by compressed levels,
+// deduplicating by hashing & by sorting, with 1 up to N threads
+int main(int argc, char *argv[])
+{
+    // Standard klotski puzzle
+    const Puzzle<9> largePuzzle
+    {
+        { 4, 6 }, // dims
+        { 1, 4, 2, 2, "^" }, // goal
+        { // invalid spaces
+            { 0, 5 },
+            { 3, 5 },
+        },
+        { // Initial board state
+            0, // no moves made,
+            { 1, 0, 2, 2, "@" }, // runner
+            { // blocks
+                Block{ 0, 0, 1, 2, "A" },
+                Block{ 0, 2, 1, 2, "B" },
+                Block{ 1, 2, 2, 1, "C" },
+                Block{ 1, 3, 1, 1, "D" },
+                Block{ 2, 3, 1, 1, "E" },
+                Block{ 3, 0, 1, 2, "F" },
+                Block{ 3, 2, 1, 2, "G" },
+                Block{ 0, 4, 1, 1, "H" },
+                Block{ 3, 4, 1, 1, "I" }
+            }
+        }
+    };
+
+    const auto maxThreads = argc > 1 ? static_cast<unsigned>(std::stoul(argv[1])) : std::max(1u, std::thread::hardware_concurrency());
+
+    std::cout << "threads\tdedup\tmoves\tms" << std::endl;
+    for (auto threads = 1u; threads <= maxThreads; threads *= 2)
+    {
+        for (const auto deduplication : { Deduplication::Hashing, Deduplication::Sorting })
+        {
+            const auto start = std::chrono::steady_clock::now();
+            const auto moves = makeSolver(largePuzzle).solveByCompressedLevel(threads, deduplication);
+            const auto time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+            std::cout << threads << '\t' << (deduplication == Deduplication::Hashing ? "hashing" : "sorting") << '\t'
+                << moves << '\t' << time.count() << std::endl;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,50 @@
+#include <iostream>
+#include <string>
+
+#include "DistributedSolver.h"
+
+// Benchmark of the distributed search: solves the standard klotski puzzle with 1 up to N worker processes
+int main(int argc, char *argv[])
+{
+    // Standard klotski puzzle
+    const Puzzle<9> largePuzzle
+    {
+        { 4, 6 }, // dims
+        { 1, 4, 2, 2, "^" }, // goal
+        { // invalid spaces
+            { 0, 5 },
+            { 3, 5 },
+        },
+        { // Initial board state
+            0, // no moves made,
+            { 1, 0, 2, 2, "@" }, // runner
+            { // blocks
+                Block{ 0, 0, 1, 2, "A" },
+                Block{ 0, 2, 1, 2, "B" },
+                Block{ 1, 2, 2, 1, "C" },
+                Block{ 1, 3, 1, 1, "D" },
+                Block{ 2, 3, 1, 1, "E" },
+                Block{ 3, 0, 1, 2, "F" },
+                Block{ 3, 2, 1, 2, "G" },
+                Block{ 0, 4, 1, 1, "H" },
+                Block{ 3, 4, 1, 1, "I" }
+            }
+        }
+    };
+
+    const auto maxWorkers = argc > 1 ? static_cast<unsigned>(std::stoul(argv[1])) : 4u;
+
+    std::cout << "workers\tmoves\tms\tspeedup\texpanded\tsent" << std::endl;
+    double baseline = 0.0;
+    for (auto workers = 1u; workers <= maxWorkers; workers *= 2)
+    {
+        const auto stats = makeDistributedSolver(largePuzzle, workers).solve();
+        const auto milliseconds = static_cast<double>(stats.m_time.count());
+        baseline = workers == 1 ? milliseconds : baseline;
+        std::cout << stats.m_workers << '\t' << stats.m_distance << '\t' << stats.m_time.count() << '\t'
+            << (milliseconds > 0.0 ? baseline / milliseconds : 1.0) << '\t'
+            << stats.m_expandedStates << '\t' << stats.m_sentStates << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,51 @@
+#include <iostream>
+#include <string>
+
+#include "printer.h"
+#include "PuzzleGenerator.h"
+
+int main(int argc, char *argv[])
+{
+    // Board, goal & pieces of the standard klotski puzzle
+    // Positions of the pieces are ignored, every possible layout is searched
+    const Puzzle<9> family
+    {
+        { 4, 6 }, // dims
+        { 1, 4, 2, 2, "^" }, // goal
+        { // invalid spaces
+            { 0, 5 },
+            { 3, 5 },
+        },
+        { // Initial board state
+            0, // no moves made,
+            { 1, 0, 2, 2, "@" }, // runner
+            { // blocks
+                Block{ 0, 0, 1, 2, "A" },
+                Block{ 0, 2, 1, 2, "B" },
+                Block{ 1, 2, 2, 1, "C" },
+                Block{ 1, 3, 1, 1, "D" },
+                Block{ 2, 3, 1, 1, "E" },
+                Block{ 3, 0, 1, 2, "F" },
+                Block{ 3, 2, 1, 2, "G" },
+                Block{ 0, 4, 1, 1, "H" },
+                Block{ 3, 4, 1, 1, "I" }
+            }
+        }
+    };
+
+    const auto count = argc > 1 ? std::stoul(argv[1]) : 3ul;
+
+    auto generator = makePuzzleGenerator(family);
+    const auto puzzles = generator.hardest(count);
+
+    std::cout << generator.placementCount() << " layouts in " << generator.componentCount() << " components" << std::endl;
+    for (auto i = 0u; i < puzzles.size(); ++i)
+    {
+        std::cout << std::endl << "// " << puzzles[i].m_distance << " moves, "
+            << puzzles[i].m_componentSize << " reachable layouts" << std::endl;
+        printDefinition(puzzles[i].m_puzzle, "hardestPuzzle" + std::to_string(i));
+        print(puzzles[i].m_puzzle);
+    }
+
+    return puzzles.empty() ? 1 : 0;
+}
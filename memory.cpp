@@ -0,0 +1,63 @@
+#include <chrono>
+#include <iostream>
+
+#include "solver.h"
+
+// Benchmark of memory backends: solves the standard klotski puzzle level by level with the visited set
+// & frontiers in memory from operator new, base page mappings & huge page mappings, reporting the page size used
+int main()
+{
+    // Standard klotski puzzle
+    const Puzzle<9> largePuzzle
+    {
+        { 4, 6 }, // dims
+        { 1, 4, 2, 2, "^" }, // goal
+        { // invalid spaces
+            { 0, 5 },
+            { 3, 5 },
+        },
+        { // Initial board state
+            0, // no moves made,
+            { 1, 0, 2, 2, "@" }, // runner
+            { // blocks
+                Block{ 0, 0, 1, 2, "A" },
+                Block{ 0, 2, 1, 2, "B" },
+                Block{ 1, 2, 2, 1, "C" },
+                Block{ 1, 3, 1, 1, "D" },
+                Block{ 2, 3, 1, 1, "E" },
+                Block{ 3, 0, 1, 2, "F" },
+                Block{ 3, 2, 1, 2, "G" },
+                Block{ 0, 4, 1, 1, "H" },
+                Block{ 3, 4, 1, 1, "I" }
+            }
+        }
+    };
+
+    struct Backend
+    {
+        const char *m_name;
+        bool m_mapped;
+        HugePages m_hugePages;
+    };
+
+    std::cout << "memory\tmoves\tms\tmapped\thuge\tpage size" << std::endl;
+    for (const auto &backend : { Backend{ "new", false, HugePages::None }, Backend{ "mapped", true, HugePages::None },
+        Backend{ "thp", true, HugePages::Transparent }, Backend{ "hugetlb", true, HugePages::Explicit } })
+    {
+        MemoryOptions options{};
+        options.m_mappingThreshold = backend.m_mapped ? options.m_mappingThreshold : static_cast<std::size_t>(-1);
+        options.m_hugePages = backend.m_hugePages;
+        options.m_prefault = true;
+
+        // Sized for all boards seen on the way to the goal, so the visited set is mapped & pre-faulted once
+        auto solver = makeSolver(largePuzzle, options, 1 << 19);
+        const auto start = std::chrono::steady_clock::now();
+        const auto moves = solver.solveByLevel();
+        const auto time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+        const auto stats = solver.memoryStats();
+        std::cout << backend.m_name << '\t' << moves << '\t' << time.count() << '\t'
+            << stats.m_mappedBytes << '\t' << stats.m_hugePageBytes << '\t' << stats.m_pageSize << std::endl;
+    }
+
+    return 0;
+}
@@ -3,6 +3,7 @@
 #include "solver.h"
 #include <algorithm>
 #include <iostream>
+#include <string>
 
 template <int BlockCount>
 void print(const Puzzle<BlockCount> &puzzle)
@@ -58,3 +59,36 @@ void print(const Puzzle<BlockCount> &puzzle)
 
     std::cout << std::endl;
 };
+
+// Prints the puzzle as C++ source, in the same layout as the puzzles in main.cpp
+template <int BlockCount>
+void printDefinition(const Puzzle<BlockCount> &puzzle, const std::string &name)
+{
+    const auto blockLiteral = [](const Block &block)
+    {
+        return "{ " + std::to_string(block.m_startX) + ", " + std::to_string(block.m_startY) + ", "
+            + std::to_string(block.m_sizeX) + ", " + std::to_string(block.m_sizeY) + ", \"" + block.id + "\" }";
+    };
+
+    std::cout << "const Puzzle<" << BlockCount << "> " << name << std::endl;
+    std::cout << "{" << std::endl;
+    std::cout << "    { " << puzzle.m_dimensions.m_x << ", " << puzzle.m_dimensions.m_y << " }, // dims" << std::endl;
+    std::cout << "    " << blockLiteral(puzzle.m_goal) << ", // goal" << std::endl;
+    std::cout << "    { // invalid spaces" << std::endl;
+    for (const auto &spot : puzzle.m_forbiddenSpots)
+    {
+        std::cout << "        { " << spot.m_x << ", " << spot.m_y << " }," << std::endl;
+    }
+    std::cout << "    }," << std::endl;
+    std::cout << "    { // Initial board state" << std::endl;
+    std::cout << "        0, // no moves made," << std::endl;
+    std::cout << "        " << blockLiteral(puzzle.m_initialState.m_runner) << ", // runner" << std::endl;
+    std::cout << "        { // blocks" << std::endl;
+    for (auto i = 0; i < BlockCount; ++i)
+    {
+        std::cout << "            Block" << blockLiteral(puzzle.m_initialState.m_blocks[i]) << (i + 1 < BlockCount ? "," : "") << std::endl;
+    }
+    std::cout << "        }" << std::endl;
+    std::cout << "    }" << std::endl;
+    std::cout << "};" << std::endl;
+}
@@ -1,14 +1,28 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <istream>
 #include <list>
 #include <memory>
+#include <ostream>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
 #include "BoardHasher.h"
+#include "CompactVisitedSet.h"
+#include "CompressedFrontier.h"
+#include "Frontier.h"
+#include "MemoryBackend.h"
 #include "MoveDiscovery.h"
 #include "MoveValidation.h"
+#include "Parallel.h"
+#include "RadixSort.h"
+#include "Serialization.h"
+#include "VisitedSet.h"
 #include "printer.h"
 
 template <int BlockCount>
@@ -18,6 +32,22 @@ bool isSolution(const BoardState<BlockCount>& state, const Block &goal)
         && state.m_runner.m_startY == goal.m_startY;
 };
 
+// Only a move of the runner can turn a board which isn't solved yet into a solution
+// Only the moved runner is looked at, the board after the move is left for the caller to build once
+template <int BlockCount>
+bool movesRunnerToGoal(const Move<BlockCount> &candidate, const Block &goal)
+{
+    if (!same(candidate.m_block, candidate.m_state->m_runner))
+    {
+        return false;
+    }
+
+    // Same test as isSolution
+    const auto runner = move(candidate.m_block, candidate.m_directionToMove);
+    return runner.m_startX == goal.m_startX
+        && runner.m_startY == goal.m_startY;
+};
+
 template <int BlockCount>
 bool containsMove(const std::list<Move<BlockCount>> &moves, const Move<BlockCount> &move)
 {
@@ -29,21 +59,117 @@ bool containsMove(const std::list<Move<BlockCount>> &moves, const Move<BlockCoun
     });
 };
 
+enum class MoveMetric
+{
+    // Every single-cell slide of a block is a move
+    Steps,
+
+    // Consecutive slides of the same block count as a single move
+    PieceMoves,
+};
+
+// How a level search recognises boards it has seen before
+enum class Deduplication
+{
+    // Probe a visited set with the hash of every child
+    Hashing,
+
+    // Sort the compact keys of all children of a level & subtract the previous & current levels from them
+    Sorting,
+};
+
+// Limits for a single call to solveWithBudget(), zero means unlimited
+struct SearchBudget
+{
+    std::chrono::milliseconds m_time;
+    std::size_t m_expandedStates;
+};
+
+enum class SearchStatus
+{
+    Solved,
+    Unsolvable,
+    OutOfBudget,
+    Cancelled,
+};
+
+struct SearchResult
+{
+    SearchStatus m_status;
+
+    // Solved: number of moves to the goal
+    // Unsolvable: -1
+    // OutOfBudget, Cancelled: depth searched so far, no solution is shorter than this
+    int m_distance;
+
+    // Number of states expanded during this call
+    std::size_t m_expandedStates;
+};
+
+// Where a paused level search stands
+struct SearchProgress
+{
+    // Level being expanded
+    int m_depth;
+
+    // States expanded so far, over all levels
+    std::size_t m_expandedStates;
+
+    // States of the level being expanded
+    std::size_t m_frontierSize;
+};
+
+template <int BlockCount>
+struct GoalResult
+{
+    // Number of moves needed to reach the goal, -1 if it can't be reached or the budget ran out first
+    int m_distance;
+
+    // All states from the initial state up to & including the first state reaching the goal
+    std::vector<BoardState<BlockCount>> m_path;
+
+    // Solved, Unsolvable or OutOfBudget
+    SearchStatus m_status;
+};
+
+// Visited is the set of boards seen by the level search, see VisitedSet.h & CompactVisitedSet.h
 template <
     int BlockCount,
-    typename MoveDiscovery
+    typename MoveDiscovery,
+    typename Visited = VisitedSet<>
 >
 class Solver
 {
 public:
     using BoardStateId = int;
     using MovesFromStart = typename std::remove_const<decltype(BoardState<BlockCount>::m_numberOfMovesFromStart)>::type;
+    using Goal = std::function<bool(const BoardState<BlockCount> &)>;
+
+    // Called with the index of a goal & its result, as soon as the search first reaches it
+    using GoalReached = std::function<void(std::size_t, const GoalResult<BlockCount> &)>;
 
 public:
     Solver(const Puzzle<BlockCount> &puzzle)
+        : Solver{ puzzle, BoardHasher<>{ puzzle } }
+    {
+    }
+
+    // Reuses the codes of a hasher created for a puzzle with the same dimensions & block sizes,
+    // instead of generating new random codes
+    // The frontiers of the level search come from memory, pass the same backend to visited to report them together
+    Solver(const Puzzle<BlockCount> &puzzle, const BoardHasher<> &hasher, Visited visited = Visited{}, std::shared_ptr<MemoryBackend> memory = nullptr)
         : m_puzzle{ puzzle }
-        , m_hasher{ puzzle }
+        , m_hasher{ hasher }
+        , m_depth{ 0 }
+        , m_expanded{ 0 }
+        , m_frontier{ puzzle.m_initialState, memory }
+        , m_next{ puzzle.m_initialState, memory }
+        , m_visited{ std::move(visited) }
+        , m_memory{ memory }
     {
+        m_visited.insert(m_hasher.hash(m_puzzle.m_initialState), 0);
+        m_frontier.push_back(m_puzzle.m_initialState);
+
         const auto initialMoves = MoveDiscovery::gatherMoves(
             puzzle.m_dimensions,
             std::make_shared<BoardState<BlockCount>>(m_puzzle.m_initialState),
@@ -165,6 +291,13 @@ public:
 
                 for (auto &move : newMoves)
                 {
+                    if (movesRunnerToGoal(move, m_puzzle.m_goal))
+                    {
+                        // Solution found while generating, no need to queue the rest of this level
+                        // Queue it first so it gets reported on the next iteration
+                        m_possibleMoves.push_front(move);
+                        break;
+                    }
                     m_possibleMoves.push_back(std::move(move));
                 }
 
@@ -213,6 +346,13 @@ public:
 
                 for (auto &move : newMoves)
                 {
+                    // Check for the goal when generating moves rather than when popping them,
+                    // otherwise a whole extra level gets queued after a solution is already known.
+                    // BFS generates moves in order of distance, so the first solution generated is a shortest one.
+                    if (movesRunnerToGoal(move, m_puzzle.m_goal))
+                    {
+                        return move.m_state->m_numberOfMovesFromStart + 1;
+                    }
                     m_possibleMoves.push_back(std::move(move));
                 }
             }
@@ -221,12 +361,531 @@ public:
         return -1;
     }
 
+    // Level-synchronous variant of solve()
+    MovesFromStart solveByLevel()
+    {
+        return solveWithBudget(SearchBudget{}).m_distance;
+    }
+
+    // Level-synchronous search keeping each level as a CompressedFrontier, for levels too wide to keep as a Frontier
+    // A round of chunks, one per thread, is decoded & expanded in parallel,
+    // the children of the round are then deduplicated & appended to the next level in chunk order.
+    // Deduplication::Sorting replaces the visited set by sequential passes over sorted levels, see solveBySortedLevel()
+    MovesFromStart solveByCompressedLevel(unsigned threads = 1, Deduplication deduplication = Deduplication::Hashing)
+    {
+        if (deduplication == Deduplication::Sorting)
+        {
+            return solveBySortedLevel(threads);
+        }
+
+        using Key = typename CompressedFrontier<BlockCount>::Key;
+        struct Expansion
+        {
+            std::vector<Key> m_keys;
+            std::vector<BoardStateId> m_hashes;
+            bool m_solved;
+        };
+
+        if (isSolution(m_puzzle.m_initialState, m_puzzle.m_goal))
+        {
+            return 0;
+        }
+
+        VisitedSet<BoardStateId, MovesFromStart> visited{};
+        visited.insert(m_hasher.hash(m_puzzle.m_initialState), 0);
+        CompressedFrontier<BlockCount> frontier{ m_puzzle.m_initialState, m_puzzle.m_dimensions };
+        CompressedFrontier<BlockCount> next{ m_puzzle.m_initialState, m_puzzle.m_dimensions };
+        frontier.push_back(m_puzzle.m_initialState);
+        frontier.seal();
+
+        threads = std::max(threads, 1u);
+        std::vector<Expansion> round(threads);
+        std::vector<char> isNew;
+        for (MovesFromStart depth = 0; !frontier.empty(); ++depth)
+        {
+            for (std::size_t firstChunk = 0; firstChunk < frontier.chunkCount(); firstChunk += threads)
+            {
+                const auto expand = [&](unsigned worker)
+                {
+                    auto &expansion = round[worker];
+                    expansion.m_keys.clear();
+                    expansion.m_hashes.clear();
+                    expansion.m_solved = false;
+                    if (firstChunk + worker >= frontier.chunkCount())
+                    {
+                        return;
+                    }
+
+                    std::vector<Key> keys;
+                    frontier.decodeChunk(firstChunk + worker, keys);
+                    for (const auto key : keys)
+                    {
+                        const auto state = std::make_shared<BoardState<BlockCount>>(frontier.state(key, depth));
+                        for (auto &move : MoveDiscovery::gatherMoves(m_puzzle.m_dimensions, state, m_puzzle.m_forbiddenSpots))
+                        {
+                            if (movesRunnerToGoal(move, m_puzzle.m_goal))
+                            {
+                                expansion.m_solved = true;
+                                return;
+                            }
+                            const auto child = move();
+                            expansion.m_keys.push_back(next.key(child));
+                            expansion.m_hashes.push_back(m_hasher.hash(child));
+                        }
+                    }
+                };
+
+                detail::forEachWorker(threads, expand);
+
+                for (const auto &expansion : round)
+                {
+                    if (expansion.m_solved)
+                    {
+                        return depth + 1;
+                    }
+                    isNew.resize(expansion.m_hashes.size());
+                    visited.insert(expansion.m_hashes.data(), expansion.m_hashes.size(), depth + 1, isNew.data());
+                    for (auto i = 0u; i < isNew.size(); ++i)
+                    {
+                        if (isNew[i])
+                        {
+                            next.push_back(expansion.m_keys[i]);
+                        }
+                    }
+                }
+            }
+
+            next.seal();
+            frontier.swap(next);
+            next.clear();
+        }
+
+        return -1;
+    }
+
+    // Resumable level-synchronous search
+    // Each BFS level is kept as a structure-of-arrays Frontier: all children of a level are generated first,
+    // then hashed & deduplicated against the visited set in flat passes over the whole level.
+    // Visited set probes are batched, so their cache misses overlap.
+    // When the budget runs out the search pauses, a later call (or a restored checkpoint) picks up where it left off.
+    SearchResult solveWithBudget(const SearchBudget &budget)
+    {
+        // Checking the clock for every expanded state is too expensive
+        constexpr auto statesPerClockCheck = 256u;
+
+        const auto startTime = std::chrono::steady_clock::now();
+        std::size_t expandedStates = 0;
+        const auto outOfBudget = [&]()
+        {
+            return (budget.m_expandedStates > 0 && expandedStates >= budget.m_expandedStates)
+                || (budget.m_time.count() > 0
+                    && expandedStates % statesPerClockCheck == 0
+                    && std::chrono::steady_clock::now() - startTime >= budget.m_time);
+        };
+
+        if (m_depth == 0 && m_expanded == 0 && isSolution(m_puzzle.m_initialState, m_puzzle.m_goal))
+        {
+            return SearchResult{ SearchStatus::Solved, 0, expandedStates };
+        }
+
+        while (!m_frontier.empty())
+        {
+            for (; m_expanded < m_frontier.size(); ++m_expanded, ++expandedStates)
+            {
+                if (outOfBudget())
+                {
+                    return SearchResult{ SearchStatus::OutOfBudget, m_depth, expandedStates };
+                }
+
+                const auto state = std::make_shared<BoardState<BlockCount>>(m_frontier.at(m_expanded, m_depth));
+                for (auto &move : MoveDiscovery::gatherMoves(m_puzzle.m_dimensions, state, m_puzzle.m_forbiddenSpots))
+                {
+                    // Goal is checked at generation time, so a solution never waits for the next level
+                    if (movesRunnerToGoal(move, m_puzzle.m_goal))
+                    {
+                        return SearchResult{ SearchStatus::Solved, m_depth + 1, expandedStates + 1 };
+                    }
+                    m_next.push_back(move(), static_cast<typename Frontier<BlockCount>::Index>(m_expanded));
+                }
+            }
+
+            m_hasher.hash(m_next, m_hashes);
+
+            m_isNew.resize(m_next.size());
+            m_visited.insert(m_hashes.data(), m_hashes.size(), m_depth + 1, m_isNew.data());
+
+            m_next.compact(m_isNew);
+            m_frontier.swap(m_next);
+            m_next.clear();
+            m_expanded = 0;
+            ++m_depth;
+        }
+
+        return SearchResult{ SearchStatus::Unsolvable, -1, expandedStates };
+    }
+
+    // Writes the state of solveWithBudget() to out, so the search can be continued by another process
+    void saveCheckpoint(std::ostream &out) const
+    {
+        serialization::write(out, checkpointMagic);
+        serialization::write(out, checkpointVersion);
+        m_hasher.write(out);
+        serialization::write(out, m_hasher.hash(m_puzzle.m_initialState));
+        serialization::write(out, m_depth);
+        serialization::write(out, static_cast<std::uint64_t>(m_expanded));
+        m_frontier.write(out);
+        m_next.write(out);
+        m_visited.write(out);
+    }
+
+    // Restores a checkpoint written by saveCheckpoint() for the same puzzle
+    void restoreCheckpoint(std::istream &in)
+    {
+        serialization::expect(in, checkpointMagic, "not a checkpoint");
+        serialization::expect(in, checkpointVersion, "checkpoint version");
+        m_hasher.read(in);
+        serialization::expect(in, m_hasher.hash(m_puzzle.m_initialState), "checkpoint is for another puzzle");
+        serialization::read(in, m_depth);
+        m_expanded = static_cast<std::size_t>(serialization::read<std::uint64_t>(in));
+        m_frontier.read(in);
+        m_next.read(in);
+        m_visited.read(in);
+    }
+
+    // Finds the minimal number of moves to the goal in the given metric
+    MovesFromStart solveInMetric(MoveMetric metric)
+    {
+        return metric == MoveMetric::Steps ? solveByLevel() : solveInPieceMoves();
+    }
+
+    // Finds the shortest path to each of the goals in a single search
+    // Results are in the same order as goals, the search stops as soon as every goal is reached,
+    // or when the budget runs out: goals which weren't reached by then are OutOfBudget
+    // reached, if given, is called for every goal as it is reached, in order of distance, while the search goes on.
+    // Note: all levels are kept until the search stops, as the path to any goal which isn't reached yet may run through them
+    std::vector<GoalResult<BlockCount>> solveForGoals(
+        const std::vector<Goal> &goals,
+        const SearchBudget &budget = SearchBudget{},
+        const GoalReached &reached = nullptr)
+    {
+        // Checking the clock for every expanded state is too expensive
+        constexpr auto statesPerClockCheck = 256u;
+
+        const auto startTime = std::chrono::steady_clock::now();
+        std::size_t expandedStates = 0;
+        const auto outOfBudget = [&]()
+        {
+            return (budget.m_expandedStates > 0 && expandedStates >= budget.m_expandedStates)
+                || (budget.m_time.count() > 0
+                    && expandedStates % statesPerClockCheck == 0
+                    && std::chrono::steady_clock::now() - startTime >= budget.m_time);
+        };
+
+        std::vector<GoalResult<BlockCount>> results(goals.size(), GoalResult<BlockCount>{ -1, {}, SearchStatus::Unsolvable });
+        auto remainingGoals = goals.size();
+
+        // All levels are kept, as paths are rebuilt through the parent of each state
+        std::vector<Frontier<BlockCount>> levels{ Frontier<BlockCount>{ m_puzzle.m_initialState } };
+        std::vector<BoardStateId> hashes;
+        std::vector<char> isNew;
+
+        VisitedSet<BoardStateId, MovesFromStart> visited{};
+        visited.insert(m_hasher.hash(m_puzzle.m_initialState), 0);
+        levels[0].push_back(m_puzzle.m_initialState);
+
+        const auto checkGoals = [&](MovesFromStart depth)
+        {
+            for (auto i = 0u; i < levels[depth].size() && remainingGoals > 0; ++i)
+            {
+                const auto state = levels[depth].at(i, depth);
+                for (auto goal = 0u; goal < goals.size(); ++goal)
+                {
+                    if (results[goal].m_distance < 0 && goals[goal](state))
+                    {
+                        results[goal] = GoalResult<BlockCount>{ depth, pathTo(levels, depth, i), SearchStatus::Solved };
+                        --remainingGoals;
+                        if (reached)
+                        {
+                            reached(goal, results[goal]);
+                        }
+                    }
+                }
+            }
+        };
+
+        checkGoals(0);
+        for (MovesFromStart depth = 0; remainingGoals > 0 && !levels[depth].empty(); ++depth)
+        {
+            Frontier<BlockCount> next{ m_puzzle.m_initialState };
+            for (auto i = 0u; i < levels[depth].size(); ++i, ++expandedStates)
+            {
+                if (outOfBudget())
+                {
+                    for (auto &result : results)
+                    {
+                        result.m_status = result.m_status == SearchStatus::Solved ? SearchStatus::Solved : SearchStatus::OutOfBudget;
+                    }
+                    return results;
+                }
+
+                const auto state = std::make_shared<BoardState<BlockCount>>(levels[depth].at(i, depth));
+                for (auto &move : MoveDiscovery::gatherMoves(m_puzzle.m_dimensions, state, m_puzzle.m_forbiddenSpots))
+                {
+                    next.push_back(move(), i);
+                }
+            }
+
+            m_hasher.hash(next, hashes);
+            isNew.resize(next.size());
+            visited.insert(hashes.data(), hashes.size(), depth + 1, isNew.data());
+            next.compact(isNew);
+
+            levels.push_back(std::move(next));
+            checkGoals(depth + 1);
+        }
+
+        return results;
+    }
+
+    // Finds the shortest path to each of the given runner positions in a single search
+    std::vector<GoalResult<BlockCount>> solveForGoals(
+        const std::vector<Block> &goalPositions,
+        const SearchBudget &budget = SearchBudget{},
+        const GoalReached &reached = nullptr)
+    {
+        std::vector<Goal> goals;
+        for (const auto &goal : goalPositions)
+        {
+            goals.push_back([goal](const BoardState<BlockCount> &state) { return isSolution(state, goal); });
+        }
+        return solveForGoals(goals, budget, reached);
+    }
+
     // Retrieves all currently queued moves
     const std::list<Move<BlockCount>>& possibleMoves()
     {
         return m_possibleMoves;
     }
 
+    SearchProgress progress() const
+    {
+        return SearchProgress{ m_depth, m_visited.size() - m_frontier.size() + m_expanded, m_frontier.size() };
+    }
+
+    // Memory & page sizes of the level search's large arrays, all zero without a MemoryBackend
+    // Note: reads /proc/self/smaps for transparent huge pages, so it isn't part of progress()
+    MemoryStats memoryStats() const
+    {
+        return m_memory ? m_memory->stats() : MemoryStats{ 0, 0, 0, 0 };
+    }
+
+    // Boards seen by the level search, e.g. to report the false positive risk of a CompactVisitedSet
+    const Visited &visited() const
+    {
+        return m_visited;
+    }
+
+private:
+    // Level search without a visited set: moves can be undone, so the children of a level are either
+    // in the previous level, in the level itself or in the next one. All children of a level are radix sorted,
+    // made unique & the previous & current levels subtracted from them in a merge pass each.
+    // The next level is appended in sorted order, keeping its chunks sorted for the next merge.
+    // Only sequential passes, which is what a level kept on disk needs as well.
+    MovesFromStart solveBySortedLevel(unsigned threads)
+    {
+        using Key = typename CompressedFrontier<BlockCount>::Key;
+        struct Expansion
+        {
+            std::vector<Key> m_keys;
+            bool m_solved;
+        };
+
+        if (isSolution(m_puzzle.m_initialState, m_puzzle.m_goal))
+        {
+            return 0;
+        }
+
+        CompressedFrontier<BlockCount> previous{ m_puzzle.m_initialState, m_puzzle.m_dimensions };
+        CompressedFrontier<BlockCount> frontier{ m_puzzle.m_initialState, m_puzzle.m_dimensions };
+        CompressedFrontier<BlockCount> next{ m_puzzle.m_initialState, m_puzzle.m_dimensions };
+        frontier.push_back(m_puzzle.m_initialState);
+        frontier.seal();
+
+        threads = std::max(threads, 1u);
+        std::vector<Expansion> round(threads);
+        std::vector<Key> children;
+        std::vector<Key> scratch;
+        for (MovesFromStart depth = 0; !frontier.empty(); ++depth)
+        {
+            children.clear();
+            for (std::size_t firstChunk = 0; firstChunk < frontier.chunkCount(); firstChunk += threads)
+            {
+                detail::forEachWorker(threads, [&](unsigned worker)
+                {
+                    auto &expansion = round[worker];
+                    expansion.m_keys.clear();
+                    expansion.m_solved = false;
+                    if (firstChunk + worker >= frontier.chunkCount())
+                    {
+                        return;
+                    }
+
+                    std::vector<Key> keys;
+                    frontier.decodeChunk(firstChunk + worker, keys);
+                    for (const auto key : keys)
+                    {
+                        const auto state = std::make_shared<BoardState<BlockCount>>(frontier.state(key, depth));
+                        for (auto &move : MoveDiscovery::gatherMoves(m_puzzle.m_dimensions, state, m_puzzle.m_forbiddenSpots))
+                        {
+                            if (movesRunnerToGoal(move, m_puzzle.m_goal))
+                            {
+                                expansion.m_solved = true;
+                                return;
+                            }
+                            expansion.m_keys.push_back(next.key(move()));
+                        }
+                    }
+                });
+
+                for (const auto &expansion : round)
+                {
+                    if (expansion.m_solved)
+                    {
+                        return depth + 1;
+                    }
+                    children.insert(end(children), begin(expansion.m_keys), end(expansion.m_keys));
+                }
+            }
+
+            radixSort(children, scratch, next.keyBits(), threads);
+            children.erase(std::unique(begin(children), end(children)), end(children));
+            previous.subtractFrom(children);
+            frontier.subtractFrom(children);
+            for (const auto key : children)
+            {
+                next.push_back(key);
+            }
+            next.seal();
+
+            previous.swap(frontier);
+            frontier.swap(next);
+            next.clear();
+        }
+
+        return -1;
+    }
+
+    // 0-1 BFS over (board, piece moved last) pairs
+    // Sliding the piece which was moved last costs nothing, moving any other piece costs a move.
+    // Free moves are queued at the front, so boards are still popped in order of distance.
+    MovesFromStart solveInPieceMoves()
+    {
+        using Index = typename Frontier<BlockCount>::Index;
+        constexpr auto noPiece = -1;
+
+        struct Node
+        {
+            Index m_index;
+            MovesFromStart m_distance;
+        };
+
+        // Note: pieces are identified by position rather than by id, as the board hash ignores block ids
+        const auto keyOf = [&](const BoardState<BlockCount> &state, int piece)
+        {
+            const auto hash = static_cast<std::uint32_t>(m_hasher.hash(state));
+            if (piece == noPiece)
+            {
+                return static_cast<BoardStateId>(hash);
+            }
+
+            const auto &block = piece == 0 ? state.m_runner : state.m_blocks[piece - 1];
+            const auto cell = static_cast<std::uint32_t>(block.m_startX * m_puzzle.m_dimensions.m_y + block.m_startY + 1);
+            return static_cast<BoardStateId>(hash ^ (cell * 0x9E3779B9u));
+        };
+
+        const auto pieceOf = [](const Move<BlockCount> &move)
+        {
+            return same(move.m_block, move.m_state->m_runner)
+                ? 0
+                : static_cast<int>(&move.m_block - move.m_state->m_blocks.data()) + 1;
+        };
+
+        // Every board queued, with the piece moved last to get there
+        Frontier<BlockCount> archive{ m_puzzle.m_initialState };
+        std::vector<int> movedLast;
+        std::unordered_map<BoardStateId, MovesFromStart> distances;
+        std::deque<Node> open;
+
+        archive.push_back(m_puzzle.m_initialState);
+        movedLast.push_back(noPiece);
+        distances[keyOf(m_puzzle.m_initialState, noPiece)] = 0;
+        open.push_back(Node{ 0, 0 });
+
+        while (!open.empty())
+        {
+            const auto node = open.front();
+            open.pop_front();
+
+            const auto state = std::make_shared<BoardState<BlockCount>>(archive.at(node.m_index, node.m_distance));
+            const auto lastPiece = movedLast[node.m_index];
+            if (distances[keyOf(*state, lastPiece)] < node.m_distance)
+            {
+                // Reached at a lower distance after being queued
+                continue;
+            }
+
+            if (isSolution(*state, m_puzzle.m_goal))
+            {
+                return node.m_distance;
+            }
+
+            for (auto &move : MoveDiscovery::gatherMoves(m_puzzle.m_dimensions, state, m_puzzle.m_forbiddenSpots))
+            {
+                const auto piece = pieceOf(move);
+                const auto cost = piece == lastPiece ? 0 : 1;
+                const auto child = move();
+
+                const auto known = distances.emplace(keyOf(child, piece), node.m_distance + cost);
+                if (!known.second)
+                {
+                    if (known.first->second <= node.m_distance + cost)
+                    {
+                        continue;
+                    }
+                    known.first->second = node.m_distance + cost;
+                }
+
+                archive.push_back(child, node.m_index);
+                movedLast.push_back(piece);
+                const auto childNode = Node{ static_cast<Index>(archive.size() - 1), node.m_distance + cost };
+                if (cost == 0)
+                {
+                    open.push_front(childNode);
+                }
+                else
+                {
+                    open.push_back(childNode);
+                }
+            }
+        }
+
+        return -1;
+    }
+
+    static std::vector<BoardState<BlockCount>> pathTo(
+        const std::vector<Frontier<BlockCount>> &levels,
+        MovesFromStart depth,
+        std::size_t index)
+    {
+        std::vector<BoardState<BlockCount>> reversedPath;
+        for (auto level = depth; level >= 0; --level)
+        {
+            reversedPath.push_back(levels[level].at(index, level));
+            index = levels[level].parent(index);
+        }
+        return std::vector<BoardState<BlockCount>>(reversedPath.rbegin(), reversedPath.rend());
+    }
+
 private:
     const Puzzle<BlockCount> m_puzzle;
     BoardHasher<> m_hasher;
@@ -237,6 +896,22 @@ private:
     // Stores the number of moves from the starting state
     std::unordered_map<BoardStateId, MovesFromStart> m_knownPaths;
 
+    // State of the level-synchronous search: the level being expanded,
+    // how many of its states were expanded already & the children generated so far
+    MovesFromStart m_depth;
+    std::size_t m_expanded;
+    Frontier<BlockCount> m_frontier;
+    Frontier<BlockCount> m_next;
+    Visited m_visited;
+    std::shared_ptr<MemoryBackend> m_memory;
+
+    // Scratch space for deduplicating a level
+    std::vector<BoardStateId> m_hashes;
+    std::vector<char> m_isNew;
+
+    constexpr static std::uint32_t checkpointMagic = 0x4353'4c4b; // "KLSC"
+    constexpr static std::uint32_t checkpointVersion = 1;
+
     // Testing rermove me
     using State = std::pair<BoardStateId, BoardState<BlockCount>>;
     std::unordered_map<BoardStateId, std::vector<State>> parentsOf;
@@ -247,3 +922,26 @@ Solver<BlockCount, MoveDiscovery> makeSolver(const Puzzle<BlockCount> &puzzle)
 {
     return Solver<BlockCount, MoveDiscovery>{ puzzle };
 }
+
+// Solver whose level search keeps its visited set & frontiers in memory of a MemoryBackend with options,
+// e.g. huge pages to save TLB misses on multi-GB searches
+// The visited set is sized for expectedStates boards up front, so its mapping is made & pre-faulted once
+// rather than every time it doubles. Frontiers still grow with the levels.
+template <int BlockCount, typename MoveDiscovery = MoveRunnerFirst<>>
+Solver<BlockCount, MoveDiscovery> makeSolver(const Puzzle<BlockCount> &puzzle, const MemoryOptions &options, std::size_t expectedStates = 1024)
+{
+    const auto memory = std::make_shared<MemoryBackend>(options);
+    return Solver<BlockCount, MoveDiscovery>{ puzzle, BoardHasher<>{ puzzle }, VisitedSet<>{ expectedStates, memory }, memory };
+}
+
+// Solver whose level search keeps the visited boards within memoryLimit bytes
+// Rarely prunes a board by mistake, see CompactVisitedSet.h
+template <int BlockCount, typename FingerprintType = std::uint16_t, typename MoveDiscovery = MoveRunnerFirst<>>
+Solver<BlockCount, MoveDiscovery, CompactVisitedSet<int, int, FingerprintType>> makeCompactSolver(
+    const Puzzle<BlockCount> &puzzle,
+    std::size_t memoryLimit,
+    std::shared_ptr<MemoryBackend> memory = nullptr)
+{
+    using Visited = CompactVisitedSet<int, int, FingerprintType>;
+    return Solver<BlockCount, MoveDiscovery, Visited>{ puzzle, BoardHasher<>{ puzzle }, Visited{ memoryLimit, memory }, memory };
+}
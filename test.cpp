@@ -1,11 +1,37 @@
 #include "test.h"
 
 #include <cassert>
+#include <cstdio>
+#include <cstdlib>
 #include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
 
 #include "solver.h"
+#include "AnytimeSolver.h"
+#include "AsyncSolver.h"
+#include "CompactVisitedSet.h"
+#include "CompressedFrontier.h"
+#include "DenseSolver.h"
+#include "DepthFirstSolver.h"
+#if defined(__unix__)
+#include <unistd.h>
+
+#include "DistributedSolver.h"
+#endif
+#include "Frontier.h"
+#include "HintEngine.h"
+#include "MemoryBackend.h"
 #include "MoveDiscovery.h"
+#include "MovePruning.h"
 #include "MoveValidation.h"
+#include "PuzzleGenerator.h"
+#include "RadixSort.h"
+#include "Fingerprint.h"
+#include "SolutionCache.h"
+#include "SolverService.h"
+#include "VisitedSet.h"
 
 
 namespace
@@ -264,6 +290,96 @@ void testHashing()
 
 }
 
+void testFrontier()
+{
+    using BoardType = std::remove_const<decltype(largePuzzle.m_initialState)>::type;
+    constexpr auto blockCount = largePuzzle.m_initialState.blockCount;
+
+    Frontier<blockCount> frontier{ largePuzzle.m_initialState };
+    assert(frontier.empty() && "A new frontier holds no states");
+
+    const auto moves = MoveRunnerFirst<>::gatherMoves(
+        largePuzzle.m_dimensions,
+        std::make_shared<BoardType>(largePuzzle.m_initialState),
+        largePuzzle.m_forbiddenSpots);
+    frontier.push_back(largePuzzle.m_initialState);
+    for (auto move : moves)
+    {
+        frontier.push_back(move());
+    }
+    assert(frontier.size() == moves.size() + 1);
+
+    const auto restored = frontier.at(0, 0);
+    assert(equalPosition(restored.m_runner, largePuzzle.m_initialState.m_runner));
+    for (auto i = 0; i < blockCount; ++i)
+    {
+        assert(equalPosition(restored.m_blocks[i], largePuzzle.m_initialState.m_blocks[i]));
+        assert(same(restored.m_blocks[i], largePuzzle.m_initialState.m_blocks[i]));
+    }
+
+    BoardHasher<> hasher{ largePuzzle };
+    std::vector<int> hashes;
+    hasher.hash(frontier, hashes);
+    assert(hashes.size() == frontier.size());
+    for (auto i = 0u; i < frontier.size(); ++i)
+    {
+        assert(hashes[i] == hasher.hash(frontier.at(i, 0)) && "Level hashing should match hashing a single state");
+    }
+
+    std::vector<char> keep(frontier.size(), 0);
+    keep[1] = 1;
+    frontier.compact(keep);
+    assert(frontier.size() == 1);
+    assert(hasher.hash(frontier.at(0, 1)) == hashes[1] && "Compacting should keep the selected states");
+}
+
+void testVisitedSet()
+{
+    VisitedSet<> visited{ 4 };
+    assert(visited.size() == 0);
+    assert(!visited.contains(42));
+
+    assert(visited.insert(42, 3) && "Unknown hashes should be inserted");
+    assert(!visited.insert(42, 5) && "Known hashes should not be inserted twice");
+    assert(visited.find(42) == 3 && "The first distance found should be kept");
+
+    // Force a few resizes & collisions on the low bits
+    for (auto i = 0; i < 1000; ++i)
+    {
+        assert(visited.insert((i << 16) | 7, i));
+    }
+    assert(visited.size() == 1001);
+    for (auto i = 0; i < 1000; ++i)
+    {
+        assert(visited.find((i << 16) | 7) == i);
+    }
+    assert(visited.find(42) == 3);
+    assert(visited.find(-42) < 0);
+
+    // Batched inserts, with duplicates both inside the batch & against earlier inserts
+    std::vector<int> batch;
+    for (auto i = 0; i < 100; ++i)
+    {
+        batch.push_back(i % 50 == 0 ? 42 : -i);
+    }
+    batch.push_back(-1);
+    std::vector<char> isNew(batch.size());
+    visited.insert(batch.data(), batch.size(), 7, isNew.data());
+    assert(!isNew[0] && !isNew[50] && "Known hashes should not be new");
+    assert(isNew[1] && !isNew[100] && "Only the first of a duplicate in a batch should be new");
+    assert(std::count(begin(isNew), end(isNew), 1) == 98);
+    assert(visited.find(-99) == 7);
+    assert(visited.size() == 1001 + 98);
+
+    // The table grows for the new hashes of a batch, not for its duplicates
+    VisitedSet<> known{ 4 };
+    const std::vector<int> repeated(1000, 42);
+    isNew.resize(repeated.size());
+    known.insert(repeated.data(), repeated.size(), 0, isNew.data());
+    assert(known.size() == 1 && std::count(begin(isNew), end(isNew), 1) == 1);
+    assert(known.capacity() < repeated.size() && "Duplicates should not make room for themselves");
+}
+
 void testSolver()
 {
     {
@@ -313,6 +429,1175 @@ void testSolver()
     }
 }
 
+namespace
+{
+    // Plain BFS without any of the solver's shortcuts, checking for the goal when a state is popped
+    template <int BlockCount>
+    int referenceDistance(const Puzzle<BlockCount> &puzzle)
+    {
+        BoardHasher<> hasher{ puzzle };
+        std::unordered_map<int, int> known{ { hasher.hash(puzzle.m_initialState), 0 } };
+        std::list<std::shared_ptr<BoardState<BlockCount>>> queue{ std::make_shared<BoardState<BlockCount>>(puzzle.m_initialState) };
+
+        while (!queue.empty())
+        {
+            const auto state = queue.front();
+            queue.pop_front();
+            if (isSolution(*state, puzzle.m_goal))
+            {
+                return state->m_numberOfMovesFromStart;
+            }
+
+            for (auto move : MoveRunnerFirst<>::gatherMoves(puzzle.m_dimensions, state, puzzle.m_forbiddenSpots))
+            {
+                auto next = std::make_shared<BoardState<BlockCount>>(move());
+                if (known.emplace(hasher.hash(*next), next->m_numberOfMovesFromStart).second)
+                {
+                    queue.push_back(next);
+                }
+            }
+        }
+        return -1;
+    }
+
+    // Runner already on the goal
+    const Puzzle<1> solvedPuzzle
+    {
+        { 3, 3 }, // dims
+        { 1, 1, 1, 1, "$" }, // goal
+        {}, // empty spaces
+        {
+            0, // no moves made,
+            { 1, 1, 1, 1, "@" }, // runner on the goal
+            {
+                { 0, 0, 1, 1, "A" }
+            }
+        }
+    };
+}
+
+void testEarlyGoalDetection()
+{
+    // Detecting the goal at generation time must still yield the shortest distance
+    assert(makeSolver(tinyPuzzle).solve() == referenceDistance(tinyPuzzle));
+    assert(makeSolver(emptyPuzzle).solve() == referenceDistance(emptyPuzzle));
+    assert(makeSolver(smallPuzzle).solve() == referenceDistance(smallPuzzle));
+    assert(makeSolver(largePuzzle).solve() == referenceDistance(largePuzzle));
+
+    assert(makeSolver(tinyPuzzle).solve<true>() == referenceDistance(tinyPuzzle));
+    assert(makeSolver(smallPuzzle).solve<true>() == referenceDistance(smallPuzzle));
+
+    assert(makeSolver(solvedPuzzle).solveByLevel() == 0 && "A solved puzzle needs no moves");
+}
+
+void testMultipleGoals()
+{
+    using BoardType = std::remove_const<decltype(smallPuzzle.m_initialState)>::type;
+    constexpr auto blockCount = smallPuzzle.m_initialState.blockCount;
+
+    const std::vector<Block> goals{
+        smallPuzzle.m_goal,
+        Block{ 0, 0, 1, 1, "$" }, // initial position
+        Block{ 2, 0, 1, 1, "$" },
+        Block{ 1, 1, 1, 1, "$" }, // forbidden spot, unreachable
+    };
+
+    // Goals are reported as they are reached, nearest first
+    std::vector<std::size_t> reachedOrder;
+    std::vector<int> reachedDistances;
+    const auto results = makeSolver(smallPuzzle).solveForGoals(goals, SearchBudget{},
+        [&](std::size_t goal, const GoalResult<blockCount> &result)
+        {
+            reachedOrder.push_back(goal);
+            reachedDistances.push_back(result.m_distance);
+        });
+    assert(results.size() == goals.size());
+    assert(reachedOrder.size() == 3 && reachedOrder.front() == 1 && "Unreachable goals are never reported");
+    assert(std::is_sorted(begin(reachedDistances), end(reachedDistances)));
+    for (auto i = 0u; i < reachedOrder.size(); ++i)
+    {
+        assert(results[reachedOrder[i]].m_distance == reachedDistances[i]);
+    }
+    assert(results[1].m_distance == 0 && "The initial position needs no moves");
+    assert(results[3].m_distance < 0 && results[3].m_path.empty() && "Unreachable goals should not be found");
+
+    for (auto goal = 0u; goal < 3; ++goal)
+    {
+        const Puzzle<blockCount> singleGoal{ smallPuzzle.m_dimensions, goals[goal], smallPuzzle.m_forbiddenSpots, smallPuzzle.m_initialState };
+        assert(results[goal].m_distance == makeSolver(singleGoal).solveByLevel() && "Every goal should be reached at its shortest distance");
+
+        // Path should run from the initial state to the goal, one move at a time
+        const auto &path = results[goal].m_path;
+        assert(path.size() == static_cast<std::size_t>(results[goal].m_distance + 1));
+        assert(equalPosition(path.front().m_runner, smallPuzzle.m_initialState.m_runner));
+        assert(isSolution(path.back(), goals[goal]));
+        for (auto step = 1u; step < path.size(); ++step)
+        {
+            const auto moves = MoveRunnerFirst<>::gatherMoves(
+                smallPuzzle.m_dimensions,
+                std::make_shared<BoardType>(path[step - 1]),
+                smallPuzzle.m_forbiddenSpots);
+            BoardHasher<> hasher{ smallPuzzle };
+            assert(std::any_of(begin(moves), end(moves), [&](auto move) { return hasher.hash(move()) == hasher.hash(path[step]); })
+                && "Consecutive states on a path should be a single move apart");
+        }
+    }
+
+    // Goals given as predicates
+    const auto predicateResults = makeSolver(largePuzzle).solveForGoals(std::vector<Solver<9, MoveRunnerFirst<>>::Goal>{
+        [](const auto &state) { return isSolution(state, largePuzzle.m_goal); },
+        [](const auto &state) { return state.m_blocks[7].m_startX == 1; }, // move H right
+    });
+    assert(predicateResults[0].m_distance == referenceDistance(largePuzzle));
+    assert(predicateResults[1].m_distance == 1);
+}
+
+void testCheckpoints()
+{
+    const auto expected = makeSolver(largePuzzle).solveByLevel();
+
+    // Run the search in small slices, continuing every slice in a fresh solver from the previous checkpoint
+    std::string checkpoint;
+    {
+        auto solver = makeSolver(largePuzzle);
+        const auto result = solver.solveWithBudget(SearchBudget{ std::chrono::milliseconds{ 0 }, 1000 });
+        assert(result.m_status == SearchStatus::OutOfBudget);
+        assert(result.m_expandedStates == 1000);
+
+        std::ostringstream out;
+        solver.saveCheckpoint(out);
+        checkpoint = out.str();
+    }
+
+    auto slices = 1;
+    for (auto status = SearchStatus::OutOfBudget; status == SearchStatus::OutOfBudget; ++slices)
+    {
+        auto solver = makeSolver(largePuzzle);
+        std::istringstream in{ checkpoint };
+        solver.restoreCheckpoint(in);
+
+        const auto result = solver.solveWithBudget(SearchBudget{ std::chrono::milliseconds{ 0 }, 1000 });
+        status = result.m_status;
+        if (status == SearchStatus::Solved)
+        {
+            assert(result.m_distance == expected && "A resumed search should find the same solution");
+        }
+        else
+        {
+            assert(status == SearchStatus::OutOfBudget);
+            assert(result.m_distance <= expected && "Partial results should never pass the solution");
+
+            std::ostringstream out;
+            solver.saveCheckpoint(out);
+            checkpoint = out.str();
+        }
+    }
+    assert(slices > 2 && "The large puzzle should need several slices");
+
+    // Checkpoints are bound to their puzzle
+    {
+        auto solver = makeSolver(smallPuzzle);
+        std::istringstream in{ checkpoint };
+        auto threw = false;
+        try
+        {
+            solver.restoreCheckpoint(in);
+        }
+        catch (const std::runtime_error &)
+        {
+            threw = true;
+        }
+        assert(threw && "Restoring a checkpoint of another puzzle should fail");
+    }
+
+    // Unsolvable puzzles are reported as such
+    {
+        const Puzzle<0> unreachableGoal{ emptyPuzzle.m_dimensions, { 1, 1, 1, 1, "$" }, emptyPuzzle.m_forbiddenSpots, emptyPuzzle.m_initialState };
+        const auto result = makeSolver(unreachableGoal).solveWithBudget(SearchBudget{});
+        assert(result.m_status == SearchStatus::Unsolvable && result.m_distance < 0);
+    }
+}
+
+namespace
+{
+    // Checks path runs from the initial state to the goal, one move at a time
+    template <int BlockCount>
+    bool validPath(const Puzzle<BlockCount> &puzzle, const std::vector<BoardState<BlockCount>> &path)
+    {
+        BoardHasher<> hasher{ puzzle };
+        if (path.empty()
+            || hasher.hash(path.front()) != hasher.hash(puzzle.m_initialState)
+            || !isSolution(path.back(), puzzle.m_goal))
+        {
+            return false;
+        }
+
+        for (auto step = 1u; step < path.size(); ++step)
+        {
+            const auto moves = MoveRunnerFirst<>::gatherMoves(
+                puzzle.m_dimensions,
+                std::make_shared<BoardState<BlockCount>>(path[step - 1]),
+                puzzle.m_forbiddenSpots);
+            if (std::none_of(begin(moves), end(moves), [&](auto move) { return hasher.hash(move()) == hasher.hash(path[step]); }))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+void testAnytimeSolver()
+{
+    const auto optimal = makeSolver(largePuzzle).solveByLevel();
+
+    {
+        // Without budget the solver should always end up with a proven optimum
+        const auto result = makeAnytimeSolver(smallPuzzle).solve(AnytimeOptions{});
+        assert(result.m_optimal);
+        assert(result.m_length == makeSolver(smallPuzzle).solveByLevel());
+        assert(validPath(smallPuzzle, result.m_path));
+        assert(result.m_path.size() == static_cast<std::size_t>(result.m_length + 1));
+    }
+
+    {
+        AnytimeOptions options{};
+        options.m_weights = { 1.0 };
+        const auto result = makeAnytimeSolver(largePuzzle).solve(options);
+        assert(result.m_optimal);
+        assert(result.m_length == optimal);
+        assert(validPath(largePuzzle, result.m_path));
+    }
+
+    {
+        // The beam search on its own quickly finds a solution, but can't prove it
+        AnytimeOptions options{};
+        options.m_weights = {};
+        const auto result = makeAnytimeSolver(largePuzzle).solve(options);
+        assert(result.m_length >= optimal);
+        assert(!result.m_optimal);
+        assert(validPath(largePuzzle, result.m_path));
+    }
+
+    {
+        // Budget is respected
+        auto solver = makeAnytimeSolver(largePuzzle);
+        const auto result = solver.solve(AnytimeOptions{ SearchBudget{ std::chrono::milliseconds{ 0 }, 500 } });
+        assert(!result.m_optimal);
+        assert(result.m_length < 0 || validPath(largePuzzle, result.m_path));
+        assert(solver.expandedStates() == 500);
+
+        // Time budgets are only checked every so often, but still stop the search
+        AnytimeOptions timed{ SearchBudget{ std::chrono::milliseconds{ 1 }, 0 } };
+        timed.m_weights = { 1.0 };
+        const auto start = std::chrono::steady_clock::now();
+        assert(!solver.solve(timed).m_optimal);
+        assert(std::chrono::steady_clock::now() - start < std::chrono::seconds{ 1 });
+    }
+
+    {
+        // Only the final weight can prove optimality
+        AnytimeOptions options{};
+        options.m_weights = { 3.0 };
+        const auto result = makeAnytimeSolver(smallPuzzle).solve(options);
+        assert(!result.m_optimal);
+        assert(result.m_length >= makeSolver(smallPuzzle).solveByLevel());
+        assert(validPath(smallPuzzle, result.m_path));
+    }
+
+    {
+        const Puzzle<0> unreachableGoal{ emptyPuzzle.m_dimensions, { 1, 1, 1, 1, "$" }, emptyPuzzle.m_forbiddenSpots, emptyPuzzle.m_initialState };
+        const auto result = makeAnytimeSolver(unreachableGoal).solve(AnytimeOptions{});
+        assert(result.m_length < 0 && result.m_optimal && "Unsolvable puzzles should be proven so");
+    }
+}
+
+namespace
+{
+    // Plain BFS where every board reachable by sliding a single piece, over any number of cells, is one move away
+    template <int BlockCount>
+    int referencePieceMoveDistance(const Puzzle<BlockCount> &puzzle)
+    {
+        using BoardType = BoardState<BlockCount>;
+        const auto pieceOf = [](const Move<BlockCount> &move)
+        {
+            return same(move.m_block, move.m_state->m_runner) ? 0 : static_cast<int>(&move.m_block - &move.m_state->m_blocks[0]) + 1;
+        };
+
+        BoardHasher<> hasher{ puzzle };
+        std::unordered_map<int, int> known{ { hasher.hash(puzzle.m_initialState), 0 } };
+        std::list<std::shared_ptr<BoardType>> queue{ std::make_shared<BoardType>(puzzle.m_initialState) };
+
+        while (!queue.empty())
+        {
+            const auto state = queue.front();
+            queue.pop_front();
+            if (isSolution(*state, puzzle.m_goal))
+            {
+                return state->m_numberOfMovesFromStart;
+            }
+
+            for (auto piece = 0; piece <= BlockCount; ++piece)
+            {
+                std::list<std::shared_ptr<BoardType>> slides{ state };
+                std::unordered_map<int, int> slid{ { hasher.hash(*state), 0 } };
+                while (!slides.empty())
+                {
+                    const auto slide = slides.front();
+                    slides.pop_front();
+                    for (auto move : MoveRunnerFirst<>::gatherMoves(puzzle.m_dimensions, slide, puzzle.m_forbiddenSpots))
+                    {
+                        if (pieceOf(move) != piece)
+                        {
+                            continue;
+                        }
+
+                        const auto moved = move();
+                        const auto next = std::make_shared<BoardType>(BoardType{ state->m_numberOfMovesFromStart + 1, moved.m_runner, moved.m_blocks });
+                        if (slid.emplace(hasher.hash(*next), 0).second)
+                        {
+                            slides.push_back(next);
+                            if (known.emplace(hasher.hash(*next), next->m_numberOfMovesFromStart).second)
+                            {
+                                queue.push_back(next);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        return -1;
+    }
+}
+
+void testMoveMetrics()
+{
+    assert(makeSolver(smallPuzzle).solveInMetric(MoveMetric::Steps) == makeSolver(smallPuzzle).solveByLevel());
+
+    assert(makeSolver(tinyPuzzle).solveInMetric(MoveMetric::PieceMoves) == 2 && "Move the block out of the way, then the runner in one go");
+    assert(makeSolver(emptyPuzzle).solveInMetric(MoveMetric::PieceMoves) == 1 && "A single piece slides around the corner in one move");
+
+    assert(makeSolver(tinyPuzzle).solveInMetric(MoveMetric::PieceMoves) == referencePieceMoveDistance(tinyPuzzle));
+    assert(makeSolver(emptyPuzzle).solveInMetric(MoveMetric::PieceMoves) == referencePieceMoveDistance(emptyPuzzle));
+    assert(makeSolver(smallPuzzle).solveInMetric(MoveMetric::PieceMoves) == referencePieceMoveDistance(smallPuzzle));
+
+    const auto largePieceMoves = makeSolver(largePuzzle).solveInMetric(MoveMetric::PieceMoves);
+    assert(largePieceMoves == referencePieceMoveDistance(largePuzzle));
+    assert(largePieceMoves > 0 && largePieceMoves <= makeSolver(largePuzzle).solveInMetric(MoveMetric::Steps));
+}
+
+void testPuzzleGenerator()
+{
+    // Runner & 2 blocks on a 3x3 board with the center blocked: 8 * (7 * 6 / 2) layouts
+    auto generator = makePuzzleGenerator(smallPuzzle);
+    const auto puzzles = generator.hardest(5, 2);
+    assert(generator.placementCount() == 168);
+    assert(generator.indexedPlacements() == generator.placementCount());
+    assert(generator.componentCount() >= 1);
+    assert(!puzzles.empty() && puzzles.size() <= 5);
+
+    for (auto i = 0u; i < puzzles.size(); ++i)
+    {
+        assert(valid(puzzles[i].m_puzzle));
+        assert(makeSolver(puzzles[i].m_puzzle).solveByLevel() == puzzles[i].m_distance
+            && "Generated distance should match the solver");
+        assert((i == 0 || puzzles[i - 1].m_distance >= puzzles[i].m_distance) && "Hardest puzzles come first");
+    }
+    assert(puzzles[0].m_distance >= makeSolver(smallPuzzle).solveByLevel() && "No layout should be harder than the hardest one");
+
+    // The runner isn't interchangeable with a block of its size: 9 * 8 layouts
+    auto singleBlockGenerator = makePuzzleGenerator(tinyPuzzle);
+    const auto singleBlock = singleBlockGenerator.hardest(1, 1);
+    assert(singleBlockGenerator.placementCount() == 9 * 8);
+    assert(singleBlockGenerator.indexedPlacements() == singleBlockGenerator.placementCount());
+    assert(singleBlock.size() == 1);
+    assert(makeSolver(singleBlock[0].m_puzzle).solveByLevel() == singleBlock[0].m_distance);
+
+    // Every layout of the standard board has its own key, so the outcome is the same on every run
+    auto standardGenerator = makePuzzleGenerator(largePuzzle);
+    const auto standard = standardGenerator.hardest(2);
+    assert(standardGenerator.placementCount() == 918400);
+    assert(standardGenerator.indexedPlacements() == standardGenerator.placementCount());
+    assert(standardGenerator.componentCount() == 170);
+    assert(standard[0].m_distance == 60 && standard[0].m_componentSize == 914148);
+    for (const auto &puzzle : standard)
+    {
+        assert(puzzle.m_componentSize > 1);
+        assert(makeSolver(puzzle.m_puzzle).solveByLevel() == puzzle.m_distance);
+    }
+}
+
+void testSolverService()
+{
+    SolverService service{ 2 };
+
+    // smallPuzzle: 3x3 board, goal at 2,2, center blocked, 1x1 runner at origin, 2 blocks next to it
+    const std::string smallRequest = "SOLVE 3 3 2 2 1 1 1 0 0 1 1 2 1 0 1 1 0 1 1 1";
+    const auto response = service.handle(smallRequest);
+    const auto expected = makeSolver(smallPuzzle).solveByLevel();
+
+    std::istringstream in{ response };
+    std::string status;
+    auto distance = 0;
+    in >> status >> distance;
+    assert(status == "OK");
+    assert(distance == expected);
+
+    std::vector<std::string> moves;
+    for (std::string move; in >> move;)
+    {
+        assert(move.size() == 2 && std::string("@AB").find(move[0]) != std::string::npos);
+        assert(std::string("UDLR").find(move[1]) != std::string::npos);
+        moves.push_back(move);
+    }
+    assert(moves.size() == static_cast<std::size_t>(distance) && "Every move of the path should be listed");
+
+    // Repeated requests come from the cache, even with the blocks in another order: A & B swap names
+    auto swapped = response;
+    std::transform(begin(response), end(response), begin(swapped), [](char c) { return c == 'A' ? 'B' : c == 'B' ? 'A' : c; });
+    assert(swapped != response && "The runner is boxed in by both blocks");
+    assert(service.handle("SOLVE 3 3  2 2 1 1 1 0 0 1 1 2 0 1 1 1 1 0 1 1 ") == swapped);
+    assert(service.cacheStats().m_memoryHits == 1);
+
+    // Same board & block sizes share their hash codes, the repeated request above included
+    service.handle("SOLVE 3 3 2 2 1 1 1 0 0 1 1 2 2 0 1 1 0 1 1 1");
+    assert(service.metrics().m_familyHits == 2);
+
+    assert(service.handle("SOLVE 3 3 1 1 0 0 0 1 1 0") == "OK 2 @D @R");
+    assert(service.handle("SOLVE 3 3 1 1 1 1 1 0 0 1 1 0") == "OK -1" && "Unreachable goals have no path");
+    assert(service.handle("SOLVE 3 3 2 2 0 0 0 1 1 1 0 0 1 1").compare(0, 3, "ERR") == 0 && "Overlapping blocks are invalid");
+    assert(service.handle("SOLVE 3 3 2 2 0 0 0 1 1 1 3 0 1 1").compare(0, 3, "ERR") == 0 && "Blocks outside the board are invalid");
+    assert(service.handle("SOLVE 3 3").compare(0, 3, "ERR") == 0);
+    assert(service.handle("HELLO").compare(0, 3, "ERR") == 0);
+    assert(service.handle("SOLVE 128 1 127 0 0 0 0 1 1 0").compare(0, 3, "ERR") == 0 && "Boards are at most 127 wide");
+    assert(service.handle("SOLVE 1 40000 0 39999 0 0 0 1 1 0").compare(0, 3, "ERR") == 0 && "Boards are at most 127 high");
+
+    const auto stats = service.handle("STATS");
+    assert(stats.compare(0, 2, "OK") == 0);
+    assert(stats.find("requests=12") != std::string::npos);
+    assert(stats.find("errors=6") != std::string::npos);
+    assert(stats.find("memoryHits=1") != std::string::npos);
+
+    // Searches exceeding the budget are errors, & aren't cached
+    SolverService limited{ 2, {}, SearchBudget{ std::chrono::milliseconds{ 0 }, 1 } };
+    assert(limited.handle(smallRequest) == "ERR Search ran out of budget");
+    assert(limited.handle(smallRequest) == "ERR Search ran out of budget");
+    assert(limited.cacheStats().m_memoryHits == 0);
+    assert(limited.metrics().m_errors == 2);
+    assert(limited.handle("SOLVE 3 3 1 1 0 0 0 1 1 0") == "ERR Search ran out of budget");
+    SolverService sufficient{ 2, {}, SearchBudget{ std::chrono::milliseconds{ 0 }, 3 } };
+    assert(sufficient.handle("SOLVE 3 3 1 1 0 0 0 1 1 0") == "OK 2 @D @R");
+
+    // Hash codes of the least recently used board family are dropped beyond the family capacity
+    SolverService forgetful{ 0, {}, SearchBudget{}, 1 };
+    forgetful.handle("SOLVE 3 3 1 1 0 0 0 1 1 0");
+    forgetful.handle("SOLVE 3 3 1 1 0 0 0 1 1 0");
+    forgetful.handle("SOLVE 4 3 1 1 0 0 0 1 1 0");
+    assert(forgetful.handle("SOLVE 3 3 1 1 0 0 0 1 1 0") == "OK 2 @D @R");
+    assert(forgetful.metrics().m_familyHits == 1 && forgetful.metrics().m_familyEvictions == 2);
+    assert(forgetful.handle("STATS").find("familyEvictions=2") != std::string::npos);
+}
+
+void testFingerprint()
+{
+    const auto original = fingerprint(largePuzzle);
+    assert(original.m_value == fingerprint(largePuzzle).m_value && "Fingerprints should be deterministic");
+
+    // Swapping same-sized blocks
+    auto blocks = largePuzzle.m_initialState.m_blocks;
+    std::swap(blocks[0], blocks[1]);
+    const Puzzle<9> swapped{ largePuzzle.m_dimensions, largePuzzle.m_goal, largePuzzle.m_forbiddenSpots, { 0, largePuzzle.m_initialState.m_runner, blocks } };
+    assert(fingerprint(swapped).m_value == original.m_value && "Block order should not matter");
+
+    // Mirror image
+    const auto width = largePuzzle.m_dimensions.m_x;
+    const auto mirror = [&](Block block)
+    {
+        block.m_startX = width - block.m_startX - block.m_sizeX;
+        return block;
+    };
+    std::array<Block, 9> mirroredBlocks{};
+    std::transform(begin(blocks), end(blocks), begin(mirroredBlocks), mirror);
+    std::vector<Point> mirroredSpots;
+    for (const auto &spot : largePuzzle.m_forbiddenSpots)
+    {
+        mirroredSpots.push_back(Point{ width - spot.m_x - 1, spot.m_y });
+    }
+    const Puzzle<9> mirrored{ largePuzzle.m_dimensions, mirror(largePuzzle.m_goal), mirroredSpots, { 0, mirror(largePuzzle.m_initialState.m_runner), mirroredBlocks } };
+    assert(fingerprint(mirrored).m_value == original.m_value && "Mirror images should share their fingerprint");
+    assert(fingerprint(mirrored).m_description == original.m_description);
+
+    // Anything else changing changes the fingerprint
+    const Puzzle<9> otherGoal{ largePuzzle.m_dimensions, { 0, 4, 2, 2, "^" }, largePuzzle.m_forbiddenSpots, largePuzzle.m_initialState };
+    const Puzzle<9> otherSpots{ largePuzzle.m_dimensions, largePuzzle.m_goal, {}, largePuzzle.m_initialState };
+    assert(fingerprint(otherGoal).m_value != original.m_value);
+    assert(fingerprint(otherSpots).m_value != original.m_value);
+    assert(fingerprint(smallPuzzle).m_value != fingerprint(emptyPuzzle).m_value);
+
+    // Goals are mirrored by the runner's footprint, as only their start matters: the large puzzle is symmetric,
+    // but a 3 wide goal at x 0 is the mirror image of one at x 2, not x 1
+    const Puzzle<9> wideGoal{ largePuzzle.m_dimensions, { 0, 4, 3, 2, "^" }, largePuzzle.m_forbiddenSpots, largePuzzle.m_initialState };
+    const Puzzle<9> shiftedWideGoal{ largePuzzle.m_dimensions, { 1, 4, 3, 2, "^" }, largePuzzle.m_forbiddenSpots, largePuzzle.m_initialState };
+    const Puzzle<9> mirroredWideGoal{ largePuzzle.m_dimensions, { 2, 4, 3, 2, "^" }, largePuzzle.m_forbiddenSpots, largePuzzle.m_initialState };
+    assert(fingerprint(wideGoal).m_value != fingerprint(shiftedWideGoal).m_value);
+    assert(fingerprint(wideGoal).m_value == fingerprint(mirroredWideGoal).m_value);
+    assert(fingerprint(shiftedWideGoal).m_value == fingerprint(largePuzzle).m_value && "Only the start of the goal matters");
+
+    SolutionCache cache{ 4 };
+    assert(solveWithCache(shiftedWideGoal, cache).m_distance == makeSolver(largePuzzle).solveByLevel());
+    assert(solveWithCache(wideGoal, cache).m_distance == -1 && "A forbidden spot keeps the runner out of the left corner");
+    assert(cache.stats().m_misses == 2);
+}
+
+namespace
+{
+    // Fresh directory for the cache files of a test, removed again when it goes out of scope
+    // Tests remove the files they create, so only an empty directory is left to remove.
+    // Note: the current directory is used where temporary directories aren't supported
+    class TemporaryDirectory
+    {
+    public:
+        TemporaryDirectory()
+            : m_path{ "." }
+        {
+#if defined(__unix__)
+            const auto *base = std::getenv("TMPDIR");
+            auto pattern = std::string{ base != nullptr && *base != '\0' ? base : "/tmp" } + "/klotski-test-XXXXXX";
+            std::vector<char> path(begin(pattern), end(pattern));
+            path.push_back('\0');
+            if (::mkdtemp(path.data()) == nullptr)
+            {
+                throw std::runtime_error("Could not create a temporary directory");
+            }
+            m_path = path.data();
+#endif
+        }
+
+        ~TemporaryDirectory()
+        {
+#if defined(__unix__)
+            ::rmdir(m_path.c_str());
+#endif
+        }
+
+        TemporaryDirectory(const TemporaryDirectory &) = delete;
+        TemporaryDirectory &operator=(const TemporaryDirectory &) = delete;
+
+        const std::string &path() const { return m_path; }
+
+    private:
+        std::string m_path;
+    };
+}
+
+void testSolutionCache()
+{
+    const TemporaryDirectory temporary;
+    const auto &directory = temporary.path();
+    const auto solutionFile = [&](const auto &puzzle)
+    {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.sol", static_cast<unsigned long long>(fingerprint(puzzle).m_value));
+        return directory + "/" + name;
+    };
+    std::remove(solutionFile(smallPuzzle).c_str());
+
+    const auto applies = [](const auto &puzzle, const Solution &solution)
+    {
+        auto state = puzzle.m_initialState;
+        std::vector<Block> pieces{ state.m_runner };
+        pieces.insert(end(pieces), begin(state.m_blocks), end(state.m_blocks));
+        for (const auto &step : solution.m_moves)
+        {
+            const auto piece = std::find_if(begin(pieces), end(pieces), [&](const Block &block)
+            {
+                return block.m_startX == step.m_x && block.m_startY == step.m_y;
+            });
+            if (piece == end(pieces))
+            {
+                return false;
+            }
+            *piece = move(*piece, step.m_direction);
+        }
+        return pieces[0].m_startX == puzzle.m_goal.m_startX && pieces[0].m_startY == puzzle.m_goal.m_startY;
+    };
+
+    {
+        SolutionCache cache{ 1, directory };
+        const auto solved = solveWithCache(smallPuzzle, cache);
+        assert(solved.m_distance == makeSolver(smallPuzzle).solveByLevel());
+        assert(solved.m_moves.size() == static_cast<std::size_t>(solved.m_distance));
+        assert(applies(smallPuzzle, solved));
+        assert(cache.stats().m_misses == 1);
+
+        const auto cached = solveWithCache(smallPuzzle, cache);
+        assert(cached.m_distance == solved.m_distance);
+        assert(cache.stats().m_memoryHits == 1);
+
+        // Mirrored puzzle comes from the cache, with mirrored moves
+        const Puzzle<2> mirrored{ smallPuzzle.m_dimensions, { 0, 2, 1, 1, "$" }, smallPuzzle.m_forbiddenSpots,
+            { 0, { 2, 0, 1, 1, "@" }, { Block{ 1, 0, 1, 1, "A" }, Block{ 2, 1, 1, 1, "B" } } } };
+        const auto mirroredSolution = solveWithCache(mirrored, cache);
+        assert(cache.stats().m_memoryHits == 2);
+        assert(mirroredSolution.m_distance == solved.m_distance);
+        assert(applies(mirrored, mirroredSolution));
+
+        // Capacity of 1 evicts the small puzzle
+        solveWithCache(tinyPuzzle, cache);
+        assert(cache.stats().m_evictions == 1);
+    }
+
+    {
+        // A new cache finds the solution on disk
+        SolutionCache cache{ 1, directory };
+        const auto restored = solveWithCache(smallPuzzle, cache);
+        assert(cache.stats().m_diskHits == 1 && cache.stats().m_misses == 0);
+        assert(applies(smallPuzzle, restored));
+    }
+
+    std::remove(solutionFile(smallPuzzle).c_str());
+    std::remove(solutionFile(tinyPuzzle).c_str());
+}
+
+void testHintEngine()
+{
+    // Following the hints solves the puzzle in the minimum number of moves, after a single exploration
+    auto engine = makeHintEngine(largePuzzle);
+    std::vector<BoardState<9>> played{ largePuzzle.m_initialState };
+    const auto hint = engine.hint(played.back());
+    assert(hint.m_exact && hint.m_movesRemaining == makeSolver(largePuzzle).solveByLevel());
+    for (auto remaining = hint.m_movesRemaining; remaining > 0; --remaining)
+    {
+        played.push_back(applyMove(played.back(), engine.hint(played.back()).m_move));
+        assert(engine.hint(played.back()).m_movesRemaining == remaining - 1);
+    }
+    assert(isSolution(played.back(), largePuzzle.m_goal));
+    assert(engine.explorations() == 1);
+
+    // Moving away from the hint is answered from the same distance field
+    const auto sidestep = [](const auto &puzzle)
+    {
+        const auto initial = std::make_shared<BoardState<2>>(puzzle.m_initialState);
+        auto moves = MoveRunnerFirst<>::gatherMoves(puzzle.m_dimensions, initial, puzzle.m_forbiddenSpots);
+        return moves.back()();
+    };
+    auto smallEngine = makeHintEngine(smallPuzzle);
+    smallEngine.hint(smallPuzzle.m_initialState);
+    const auto detour = sidestep(smallPuzzle);
+    const Puzzle<2> detourPuzzle{ smallPuzzle.m_dimensions, smallPuzzle.m_goal, smallPuzzle.m_forbiddenSpots, detour };
+    assert(smallEngine.hint(detour).m_movesRemaining == makeSolver(detourPuzzle).solveByLevel());
+    assert(smallEngine.explorations() == 1);
+
+    // A cut off region is explored from scratch once the player leaves it, & only yields an upper bound
+    // Without a solved board in the region, the goal is out of reach of the region rather than unreachable
+    auto cutOff = makeHintEngine(largePuzzle, 10);
+    const auto cutOffHint = cutOff.hint(largePuzzle.m_initialState);
+    assert(!cutOffHint.m_exact && cutOffHint.m_movesRemaining == -1);
+    assert(cutOff.regionSize() == 10);
+    const auto far = makeSolver(largePuzzle).solveForGoals(std::vector<Block>{ largePuzzle.m_goal });
+    assert(far.front().m_path.size() > 10);
+    cutOff.hint(far.front().m_path[10]);
+    assert(cutOff.explorations() == 2);
+    cutOff.hint(largePuzzle.m_initialState);
+    assert(cutOff.explorations() == 3 && "The first region was discarded");
+}
+
+void testCompactVisitedSet()
+{
+    CompactVisitedSet<> visited{ 1 << 16 };
+    assert(visited.memoryUsage() <= (1 << 16));
+    assert(visited.insert(42, 0));
+    assert(!visited.insert(42, 1));
+    assert(visited.contains(42) && !visited.contains(43));
+
+    // Duplicates within a batch are resolved in order
+    const std::vector<int> hashes{ 1, 2, 42, 2, 3 };
+    std::vector<char> isNew(hashes.size());
+    visited.insert(hashes.data(), hashes.size(), 1, isNew.data());
+    assert((isNew == std::vector<char>{ 1, 1, 0, 0, 1 }));
+    assert(visited.size() == 4);
+
+    // Most slots can be filled, at a small risk of pruning new hashes
+    auto pruned = 0;
+    for (auto hash = 100; hash < 100 + static_cast<int>(visited.capacity() * 9 / 10); ++hash)
+    {
+        pruned += visited.insert(hash, 2) ? 0 : 1;
+    }
+    assert(visited.falsePositiveRate() > 0.0 && visited.falsePositiveRate() < 1e-3);
+    assert(pruned < 20 && visited.expectedFalsePositives() < 20);
+
+    // Beyond the memory limit inserts fail, without losing any of the hashes inserted before
+    auto full = false;
+    std::vector<int> inserted;
+    auto sizeBefore = visited.size();
+    try
+    {
+        for (auto hash = -1; hash > -static_cast<int>(visited.capacity()); --hash)
+        {
+            sizeBefore = visited.size();
+            if (visited.insert(hash, 2))
+            {
+                inserted.push_back(hash);
+            }
+        }
+    }
+    catch (const std::runtime_error &)
+    {
+        full = true;
+    }
+    assert(full);
+    assert(visited.size() == sizeBefore);
+    assert(std::all_of(begin(inserted), end(inserted), [&](int hash) { return visited.contains(hash); }));
+    for (auto hash = 100; hash < 100 + static_cast<int>(visited.capacity() * 9 / 10); ++hash)
+    {
+        assert(visited.contains(hash));
+    }
+
+    // Level search in a fraction of the memory of the exact set
+    auto exact = makeSolver(largePuzzle);
+    auto compact = makeCompactSolver<9, std::uint32_t>(largePuzzle, 4 << 20);
+    assert(compact.solveByLevel() == exact.solveByLevel());
+    assert(compact.visited().memoryUsage() < exact.visited().capacity() * 2 * sizeof(int));
+    assert(compact.visited().expectedFalsePositives() < 0.01);
+    assert(makeCompactSolver(smallPuzzle, 1 << 10).solveByLevel() == 8);
+}
+
+void testCompressedFrontier()
+{
+    // All boards up to 20 moves from the start of the large puzzle
+    std::vector<BoardState<9>> boards{ largePuzzle.m_initialState };
+    VisitedSet<> seen{};
+    BoardHasher<> hasher{ largePuzzle };
+    seen.insert(hasher.hash(largePuzzle.m_initialState), 0);
+    for (auto first = 0u, depth = 0u; depth < 20; ++depth)
+    {
+        const auto last = boards.size();
+        for (; first < last; ++first)
+        {
+            const auto state = std::make_shared<BoardState<9>>(boards[first]);
+            for (auto &move : MoveRunnerFirst<>::gatherMoves(largePuzzle.m_dimensions, state, largePuzzle.m_forbiddenSpots))
+            {
+                const auto child = move();
+                if (seen.insert(hasher.hash(child), 0))
+                {
+                    boards.push_back(child);
+                }
+            }
+        }
+    }
+
+    CompressedFrontier<9> compressed{ largePuzzle.m_initialState, largePuzzle.m_dimensions, 1024 };
+    std::vector<CompressedFrontier<9>::Key> expected;
+    for (const auto &board : boards)
+    {
+        compressed.push_back(board);
+        expected.push_back(compressed.key(board));
+    }
+    compressed.seal();
+    assert(compressed.size() == boards.size());
+    assert(compressed.chunkCount() == (boards.size() + 1023) / 1024);
+
+    // Chunks hold the sorted keys of consecutive runs of boards
+    std::vector<CompressedFrontier<9>::Key> keys;
+    for (auto chunk = 0u; chunk < compressed.chunkCount(); ++chunk)
+    {
+        compressed.decodeChunk(chunk, keys);
+        const auto run = begin(expected) + chunk * 1024;
+        std::sort(run, run + keys.size());
+        assert(std::equal(begin(keys), end(keys), run));
+    }
+    assert(compressed.key(compressed.state(expected.back(), 0)) == expected.back());
+
+    // Much smaller than a Frontier, which needs 2 bytes per piece & a parent index per board
+    assert(compressed.memoryUsage() * 4 < boards.size() * (2 * 10 + sizeof(Frontier<9>::Index)));
+
+    for (auto threads : { 1u, 4u })
+    {
+        assert(makeSolver(tinyPuzzle).solveByCompressedLevel(threads) == 3);
+        assert(makeSolver(smallPuzzle).solveByCompressedLevel(threads) == 8);
+        assert(makeSolver(largePuzzle).solveByCompressedLevel(threads) == 38);
+    }
+}
+
+#if defined(__unix__)
+void testDistributedSolver()
+{
+    for (auto workers : { 1u, 2u, 3u })
+    {
+        assert(makeDistributedSolver(tinyPuzzle, workers).solve().m_distance == 3);
+        assert(makeDistributedSolver(emptyPuzzle, workers).solve().m_distance == 4);
+
+        const auto stats = makeDistributedSolver(smallPuzzle, workers).solve();
+        assert(stats.m_distance == 8 && stats.m_workers == workers);
+        assert(stats.m_expandedStates > 0);
+        assert((stats.m_sentStates > 0) == (workers > 1));
+    }
+    assert(makeDistributedSolver(largePuzzle, 4).solve().m_distance == 38);
+}
+#endif
+
+void testAsyncSolver()
+{
+    // Progress is reported after every batch, level by level
+    std::vector<SearchProgress> reports;
+    AsyncOptions options{};
+    options.m_batchSize = 1000;
+    options.m_progress = [&](const SearchProgress &progress) { reports.push_back(progress); };
+    const auto solved = solveAsync(largePuzzle, options).get();
+    assert(solved.m_status == SearchStatus::Solved && solved.m_distance == 38);
+    assert(!reports.empty() && reports.back().m_depth <= 37);
+    for (auto i = 1u; i < reports.size(); ++i)
+    {
+        assert(reports[i].m_depth >= reports[i - 1].m_depth);
+        assert(reports[i].m_expandedStates == reports[i - 1].m_expandedStates + 1000);
+        assert(reports[i].m_frontierSize > 0);
+    }
+    assert(solved.m_expandedStates >= reports.back().m_expandedStates);
+
+    // Cancelling stops the search at the next batch
+    AsyncOptions cancelled{};
+    cancelled.m_batchSize = 100;
+    cancelled.m_progress = [&](const SearchProgress &) { cancelled.m_cancellation.cancel(); };
+    const auto stopped = solveAsync(largePuzzle, cancelled).get();
+    assert(stopped.m_status == SearchStatus::Cancelled && stopped.m_expandedStates == 100);
+
+    // As does the deadline passing
+    AsyncOptions late{};
+    late.m_deadline = std::chrono::steady_clock::now();
+    const auto expired = solveAsync(largePuzzle, late).get();
+    assert(expired.m_status == SearchStatus::OutOfBudget && expired.m_expandedStates == 0);
+
+    assert(solveAsync(smallPuzzle).get().m_distance == 8);
+}
+
+void testPatternDatabases()
+{
+    const std::vector<std::vector<int>> patterns{ { 2, 3, 4 }, { 0, 1, 5 }, { 6, 7, 8 } };
+    const auto additive = makePatternDatabaseHeuristic(largePuzzle, patterns, PatternCombination::Additive);
+    const auto maximum = makePatternDatabaseHeuristic(largePuzzle, patterns, PatternCombination::Max);
+
+    // Admissible along a shortest path, & tighter than the runner's distance
+    const auto path = makeSolver(largePuzzle).solveForGoals(std::vector<Block>{ largePuzzle.m_goal }).front().m_path;
+    for (auto i = 0u; i < path.size(); ++i)
+    {
+        const auto remaining = static_cast<int>(path.size() - 1 - i);
+        assert(additive(path[i], largePuzzle.m_goal) <= remaining);
+        assert(maximum(path[i], largePuzzle.m_goal) <= remaining);
+        assert(maximum(path[i], largePuzzle.m_goal) >= RunnerManhattanDistance{}(path[i], largePuzzle.m_goal));
+    }
+    assert(additive(largePuzzle.m_initialState, largePuzzle.m_goal) > RunnerManhattanDistance{}(largePuzzle.m_initialState, largePuzzle.m_goal));
+
+    // Same optimal solution for A*, expanding far fewer states
+    AnytimeOptions options{};
+    options.m_beamWidth = 0;
+    options.m_weights = { 1.0 };
+    auto manhattanSolver = makeAnytimeSolver(largePuzzle);
+    auto patternSolver = makeAnytimeSolver(largePuzzle, additive);
+    const auto manhattanResult = manhattanSolver.solve(options);
+    const auto patternResult = patternSolver.solve(options);
+    assert(patternResult.m_optimal && patternResult.m_length == 38 && manhattanResult.m_length == 38);
+    assert(patternSolver.expandedStates() * 3 < manhattanSolver.expandedStates());
+
+    // Blocks counted twice can't be added up
+    auto overlapping = false;
+    try
+    {
+        makePatternDatabaseHeuristic(largePuzzle, { { 2, 3 }, { 3, 4 } }, PatternCombination::Additive);
+    }
+    catch (const std::runtime_error &)
+    {
+        overlapping = true;
+    }
+    assert(overlapping);
+
+    // Databases are cached per board family & pattern
+    const TemporaryDirectory temporary;
+    const auto &directory = temporary.path();
+    const PatternDatabase<9> built{ largePuzzle, { 2, 3, 4 }, true, directory };
+    const PatternDatabase<9> cached{ largePuzzle, { 2, 3, 4 }, true, directory };
+    std::remove(built.cachePathOf(directory).c_str());
+    assert(cached.loadedFromDisk() && cached.size() == built.size());
+    for (const auto &state : path)
+    {
+        assert(cached(state) == built(state));
+    }
+
+    // Runner surrounded by forbidden spots
+    const Puzzle<1> stuck{ { 3, 3 }, { 2, 2, 1, 1, "$" }, { { 1, 0 }, { 0, 1 } }, { 0, { 0, 0, 1, 1, "@" }, { Block{ 2, 0, 1, 1, "A" } } } };
+    assert(PatternDatabase<1>(stuck, { 0 })(stuck.m_initialState) == PatternDatabase<1>::unreachable);
+}
+
+void testDenseSolver()
+{
+    // Every layout of the standard board, as counted by generate
+    const PlacementRanking<9> ranking{ largePuzzle };
+    assert(ranking.size() == 918400);
+    for (std::uint64_t rank = 0; rank < ranking.size(); rank += 997)
+    {
+        assert(ranking.rank(ranking.unrank(rank, 0)) == rank);
+    }
+
+    // Swapping blocks of the same size keeps the rank
+    auto blocks = largePuzzle.m_initialState.m_blocks;
+    std::swap(blocks[0].m_startY, blocks[1].m_startY);
+    std::swap(blocks[3].m_startX, blocks[4].m_startX);
+    const BoardState<9> swapped{ 0, largePuzzle.m_initialState.m_runner, blocks };
+    assert(ranking.rank(swapped) == ranking.rank(largePuzzle.m_initialState));
+
+    for (auto threads : { 1u, 3u })
+    {
+        assert(makeDenseSolver(tinyPuzzle).solve(threads).m_distance == 3);
+        assert(makeDenseSolver(emptyPuzzle).solve(threads).m_distance == 4);
+        assert(makeDenseSolver(smallPuzzle).solve(threads).m_distance == 8);
+        assert(makeDenseSolver(largePuzzle).solve(threads).m_distance == 38);
+        assert(makeDenseSolver(solvedPuzzle).solve(threads).m_distance == 0);
+    }
+
+    // Exhaustive search reaches the same layouts as the hint engine explores
+    auto smallEngine = makeHintEngine(smallPuzzle);
+    smallEngine.hint(smallPuzzle.m_initialState);
+    const auto exhaustive = makeDenseSolver(smallPuzzle).solve(2, true);
+    assert(exhaustive.m_distance == 8 && exhaustive.m_depth >= 8);
+    assert(exhaustive.m_reachedStates == smallEngine.regionSize());
+
+    // 2 bits per layout
+    auto large = makeDenseSolver(largePuzzle);
+    const auto all = large.solve(2, true);
+    assert(all.m_distance == 38 && all.m_reachedStates <= ranking.size());
+    assert(large.memoryUsage() * 4 <= ranking.size() + 32 * 4);
+}
+
+namespace
+{
+    // Shortest distance found by the depth first solver with each set of pruning rules, -1 if they disagree
+    template <int BlockCount>
+    int depthFirstDistance(const Puzzle<BlockCount> &puzzle)
+    {
+        auto none = makeDepthFirstSolver<BlockCount, MovePruning<PruningRules::None>>(puzzle);
+        auto reversals = makeDepthFirstSolver<BlockCount, MovePruning<PruningRules::Reversals>>(puzzle);
+        auto all = makeDepthFirstSolver(puzzle);
+
+        const auto distance = none.solve().m_distance;
+        if (reversals.solve().m_distance != distance || all.solve().m_distance != distance
+            || !validPath(puzzle, all.path()) || all.path().size() != static_cast<std::size_t>(distance + 1))
+        {
+            return -1;
+        }
+
+        // Every rule only removes moves
+        assert(all.expandedStates() <= reversals.expandedStates());
+        assert(reversals.expandedStates() <= none.expandedStates());
+        return distance;
+    }
+}
+
+void testMovePruning()
+{
+    {
+        const auto state = std::make_shared<BoardState<2>>(smallPuzzle.m_initialState);
+        const auto dims = smallPuzzle.m_dimensions;
+        const auto &forbidden = smallPuzzle.m_forbiddenSpots;
+        const auto moves = MovePruning<>::gatherMoves(dims, state, forbidden);
+        assert(moves.size() == MoveRunnerFirst<>::gatherMoves(dims, state, forbidden).size());
+
+        // A moving right to (2, 0): moving it back is a reversal
+        auto right = *std::find_if(begin(moves), end(moves), [](const auto &move) { return move.m_history.m_piece == 1; });
+        assert(right.m_move.m_directionToMove == Right);
+        const auto afterRight = std::make_shared<BoardState<2>>(right.m_move());
+        const auto backLeft = [](const auto &move) { return move.m_history.m_piece == 1 && move.m_history.m_direction == Left; };
+        const auto unpruned = MovePruning<PruningRules::None>::gatherMoves(dims, afterRight, forbidden, right.m_history);
+        assert(std::any_of(begin(unpruned), end(unpruned), backLeft));
+        const auto pruned = MovePruning<>::gatherMoves(dims, afterRight, forbidden, right.m_history);
+        assert(std::none_of(begin(pruned), end(pruned), backLeft));
+
+        // B moving down doesn't interact with A moving right, so moving A right after B is pruned:
+        // the same board is reached by moving A first, as B comes after A in piece order
+        auto down = *std::find_if(begin(moves), end(moves), [](const auto &move) { return move.m_history.m_piece == 2; });
+        assert(down.m_move.m_directionToMove == Down);
+        const auto afterDown = std::make_shared<BoardState<2>>(down.m_move());
+        const auto aRight = [](const auto &move) { return move.m_history.m_piece == 1 && move.m_history.m_direction == Right; };
+        const auto commuted = MovePruning<>::gatherMoves(dims, afterDown, forbidden, down.m_history);
+        assert(std::none_of(begin(commuted), end(commuted), aRight));
+        const auto reversalsOnly = MovePruning<PruningRules::Reversals>::gatherMoves(dims, afterDown, forbidden, down.m_history);
+        assert(std::any_of(begin(reversalsOnly), end(reversalsOnly), aRight));
+
+        // The runner moving into the cell B left does interact with it
+        const auto runnerDown = [](const auto &move) { return move.m_history.m_piece == 0 && move.m_history.m_direction == Down; };
+        assert(std::any_of(begin(commuted), end(commuted), runnerDown));
+    }
+
+    // Pruning keeps the shortest solution
+    assert(depthFirstDistance(tinyPuzzle) == referenceDistance(tinyPuzzle));
+    assert(depthFirstDistance(emptyPuzzle) == referenceDistance(emptyPuzzle));
+    assert(depthFirstDistance(smallPuzzle) == referenceDistance(smallPuzzle));
+    assert(depthFirstDistance(solvedPuzzle) == 0);
+
+    // From boards along walks through the small puzzle
+    for (auto walk = 0u; walk < 12; ++walk)
+    {
+        auto state = std::make_shared<BoardState<2>>(smallPuzzle.m_initialState);
+        for (auto step = 0u; step < 3 * walk; ++step)
+        {
+            auto moves = MoveRunnerFirst<>::gatherMoves(smallPuzzle.m_dimensions, state, smallPuzzle.m_forbiddenSpots);
+            state = std::make_shared<BoardState<2>>(moves[(7 * step + walk) % moves.size()]());
+        }
+        const Puzzle<2> walked{ smallPuzzle.m_dimensions, smallPuzzle.m_goal, smallPuzzle.m_forbiddenSpots, BoardState<2>{ 0, state->m_runner, state->m_blocks } };
+        assert(depthFirstDistance(walked) == referenceDistance(walked));
+    }
+
+    // Near the end of the standard puzzle, where the branching factor is large
+    AnytimeOptions options{};
+    options.m_weights = { 1.0 };
+    const auto path = makeAnytimeSolver(largePuzzle).solve(options).m_path;
+    const auto &nearGoal = path[path.size() - 11];
+    const Puzzle<9> endGame{ largePuzzle.m_dimensions, largePuzzle.m_goal, largePuzzle.m_forbiddenSpots, BoardState<9>{ 0, nearGoal.m_runner, nearGoal.m_blocks } };
+    auto none = makeDepthFirstSolver<9, MovePruning<PruningRules::None>>(endGame);
+    auto all = makeDepthFirstSolver(endGame);
+    assert(none.solve().m_distance == 10);
+    assert(all.solve().m_distance == 10);
+    assert(validPath(endGame, all.path()));
+    std::cout << "depth first end game: " << none.expandedStates() << " states expanded without pruning, "
+        << all.expandedStates() << " with pruning" << std::endl;
+    assert(all.expandedStates() * 10 < none.expandedStates());
+
+    // Bounded search
+    const auto bounded = makeDepthFirstSolver(endGame).solve(6);
+    assert(bounded.m_status == SearchStatus::OutOfBudget && bounded.m_distance == 6);
+}
+
+void testSortedDeduplication()
+{
+    // Enough keys for several threads, with a constant high digit which gets skipped
+    std::vector<std::uint64_t> keys;
+    std::uint64_t value = 1;
+    for (auto i = 0u; i < 100000; ++i)
+    {
+        value = value * 6364136223846793005ULL + 1442695040888963407ULL;
+        keys.push_back((value >> 20) & 0xff00ffffffffULL);
+    }
+    for (auto threads : { 1u, 3u })
+    {
+        auto sorted = keys;
+        std::vector<std::uint64_t> scratch;
+        radixSort(sorted, scratch, 48, threads);
+        auto expected = keys;
+        std::sort(begin(expected), end(expected));
+        assert(sorted == expected);
+    }
+
+    // Boards only differing by swapping blocks of the same size share a key
+    CompressedFrontier<9> level{ largePuzzle.m_initialState, largePuzzle.m_dimensions, 2 };
+    auto blocks = largePuzzle.m_initialState.m_blocks;
+    std::swap(blocks[0].m_startY, blocks[1].m_startY);
+    const BoardState<9> swapped{ 0, largePuzzle.m_initialState.m_runner, blocks };
+    assert(level.key(swapped) == level.key(largePuzzle.m_initialState));
+
+    // Subtracting a level keeps the keys it doesn't hold, in order
+    for (const auto key : { 2, 3, 5, 8, 13 })
+    {
+        level.push_back(static_cast<CompressedFrontier<9>::Key>(key));
+    }
+    level.seal();
+    assert(level.sorted() && level.chunkCount() == 3);
+    std::vector<CompressedFrontier<9>::Key> candidates{ 1, 2, 4, 5, 13, 21 };
+    level.subtractFrom(candidates);
+    assert((candidates == std::vector<CompressedFrontier<9>::Key>{ 1, 4, 21 }));
+
+    level.push_back(1);
+    level.seal();
+    assert(!level.sorted());
+
+    for (auto threads : { 1u, 3u })
+    {
+        assert(makeSolver(tinyPuzzle).solveByCompressedLevel(threads, Deduplication::Sorting) == 3);
+        assert(makeSolver(emptyPuzzle).solveByCompressedLevel(threads, Deduplication::Sorting) == 4);
+        assert(makeSolver(smallPuzzle).solveByCompressedLevel(threads, Deduplication::Sorting) == 8);
+        assert(makeSolver(solvedPuzzle).solveByCompressedLevel(threads, Deduplication::Sorting) == 0);
+        assert(makeSolver(largePuzzle).solveByCompressedLevel(threads, Deduplication::Sorting) == 38);
+    }
+
+    const Puzzle<0> unreachableGoal{ emptyPuzzle.m_dimensions, { 1, 1, 1, 1, "$" }, emptyPuzzle.m_forbiddenSpots, emptyPuzzle.m_initialState };
+    assert(makeSolver(unreachableGoal).solveByCompressedLevel(1, Deduplication::Sorting) == -1);
+}
+
+void testMemoryBackend()
+{
+    MemoryOptions options{};
+    options.m_mappingThreshold = 1 << 16;
+    options.m_prefault = true;
+    options.m_firstTouchThreads = 3;
+    const auto memory = std::make_shared<MemoryBackend>(options);
+
+    {
+        // Small allocations come from operator new, large ones are mapped
+        std::vector<int, BackendAllocator<int>> small(16, 7, BackendAllocator<int>{ memory });
+        std::vector<int, BackendAllocator<int>> large(1 << 20, 7, BackendAllocator<int>{ memory });
+        assert(std::all_of(begin(large), end(large), [](int value) { return value == 7; }));
+        auto stats = memory->stats();
+        assert(stats.m_bytes == (16 + (1 << 20)) * sizeof(int));
+#if defined(__linux__)
+        assert(stats.m_mappedBytes == (1 << 20) * sizeof(int));
+#endif
+        assert(stats.m_hugePageBytes <= stats.m_mappedBytes);
+        assert(stats.m_pageSize >= MemoryBackend::basePageSize());
+        assert(stats.m_hugePageBytes == 0 || stats.m_pageSize == MemoryBackend::hugePageSize());
+
+        // Swapping containers swaps their backends along
+        std::vector<int, BackendAllocator<int>> plain(1 << 20, 1);
+        plain.swap(large);
+        assert(plain.get_allocator().backend() == memory && !large.get_allocator().backend());
+    }
+    assert(memory->stats().m_bytes == 0);
+
+    // Explicit huge pages fall back to other pages when none are reserved
+    options.m_hugePages = HugePages::Explicit;
+    const auto explicitMemory = std::make_shared<MemoryBackend>(options);
+    {
+        std::vector<char, BackendAllocator<char>> pages(3 << 20, 1, BackendAllocator<char>{ explicitMemory });
+        assert(pages[(3 << 20) - 1] == 1 && explicitMemory->stats().m_bytes == 3u << 20);
+    }
+
+    // Searches on every kind of memory find the same distance
+    for (const auto hugePages : { HugePages::None, HugePages::Transparent, HugePages::Explicit })
+    {
+        MemoryOptions searchOptions{};
+        searchOptions.m_hugePages = hugePages;
+        searchOptions.m_mappingThreshold = 1 << 12;
+        auto solver = makeSolver(largePuzzle, searchOptions);
+        assert(solver.solveByLevel() == 38);
+        const auto stats = solver.memoryStats();
+        assert(stats.m_bytes > 0 && stats.m_pageSize >= MemoryBackend::basePageSize());
+        assert(hugePages != HugePages::None || stats.m_hugePageBytes == 0);
+        std::cout << "memory backend: " << stats.m_mappedBytes << " bytes mapped, " << stats.m_hugePageBytes
+            << " on huge pages, page size " << stats.m_pageSize << std::endl;
+    }
+    assert(makeSolver(smallPuzzle).memoryStats().m_bytes == 0);
+
+    // Sized up front, the visited set of the standard puzzle (~400k boards) never grows
+    {
+        MemoryOptions searchOptions{};
+        searchOptions.m_prefault = true;
+        searchOptions.m_firstTouchThreads = 2;
+        searchOptions.m_firstTouchCpus = { 0 };
+        auto solver = makeSolver(largePuzzle, searchOptions, 1 << 19);
+        const auto capacity = solver.visited().capacity();
+        assert(solver.solveByLevel() == 38);
+        assert(solver.visited().capacity() == capacity);
+    }
+
+    auto compact = makeCompactSolver(smallPuzzle, 1 << 20, memory);
+    assert(compact.solveByLevel() == 8);
+    assert(compact.memoryStats().m_bytes >= compact.visited().memoryUsage());
+}
+
+void testLevelSolver()
+{
+    assert(makeSolver(tinyPuzzle).solveByLevel() == makeSolver(tinyPuzzle).solve());
+    assert(makeSolver(emptyPuzzle).solveByLevel() == makeSolver(emptyPuzzle).solve());
+    assert(makeSolver(smallPuzzle).solveByLevel() == makeSolver(smallPuzzle).solve());
+    assert(makeSolver(largePuzzle).solveByLevel() == makeSolver(largePuzzle).solve());
+}
+
 int main(int argc, char *argv[])
 {
     testBlocks();
@@ -321,5 +1606,29 @@ int main(int argc, char *argv[])
     testMoveDiscovery();
     testMoving();
     testHashing();
+    testFrontier();
+    testVisitedSet();
     testSolver();
+    testLevelSolver();
+    testEarlyGoalDetection();
+    testMultipleGoals();
+    testCheckpoints();
+    testAnytimeSolver();
+    testMoveMetrics();
+    testPuzzleGenerator();
+    testSolverService();
+    testFingerprint();
+    testSolutionCache();
+    testHintEngine();
+    testCompactVisitedSet();
+    testCompressedFrontier();
+#if defined(__unix__)
+    testDistributedSolver();
+#endif
+    testAsyncSolver();
+    testPatternDatabases();
+    testDenseSolver();
+    testMovePruning();
+    testSortedDeduplication();
+    testMemoryBackend();
 }
\ No newline at end of file